@@ -0,0 +1,153 @@
+// Lending of idle dedicated CPUs between tasks. See core_lending.h.
+
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "core_lending.h"
+
+using namespace std;
+
+static __thread LendingTask *thread_lending_task = NULL;
+
+uint64_t lending_now() {
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static LendingBoard *map_board(int fd) {
+	void *addr = mmap(NULL, sizeof(LendingBoard), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	return (addr == MAP_FAILED) ? NULL : (LendingBoard*) addr;
+}
+
+LendingBoard *create_lending_board(const char *name) {
+	int fd = shm_open(name, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+	if (fd == -1) {
+		return NULL;
+	}
+	if (ftruncate(fd, sizeof(LendingBoard)) != 0) {
+		close(fd);
+		shm_unlink(name);
+		return NULL;
+	}
+
+	LendingBoard *board = map_board(fd);
+	if (board == NULL) {
+		shm_unlink(name);
+		return NULL;
+	}
+
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+	pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+	int ret_val = pthread_mutex_init(&board->lock, &attr);
+	pthread_mutexattr_destroy(&attr);
+	if (ret_val != 0) {
+		close_lending_board(board, name);
+		return NULL;
+	}
+
+	// The new shared memory is zero-filled: every CPU is owned
+	board->num_tasks = 0;
+	for (unsigned cpu=0; cpu<kLendingMaxCpus; cpu++) {
+		board->cpus[cpu].lender = -1;
+		board->cpus[cpu].borrower = -1;
+	}
+	return board;
+}
+
+LendingBoard *open_lending_board(const char *name) {
+	int fd = shm_open(name, O_RDWR, 0);
+	if (fd == -1) {
+		return NULL;
+	}
+	return map_board(fd);
+}
+
+int lending_join(LendingBoard *board) {
+	pthread_mutex_lock(&board->lock);
+	int slot = board->num_tasks++;
+	pthread_mutex_unlock(&board->lock);
+	return slot;
+}
+
+void lend_cpus(LendingBoard *board, int slot, const vector<unsigned> &cpus, uint64_t duration) {
+	uint64_t return_by = lending_now() + duration;
+	pthread_mutex_lock(&board->lock);
+	for (unsigned i=0; i<cpus.size(); i++) {
+		if (cpus[i] >= kLendingMaxCpus) continue;
+		LentCpu &cpu = board->cpus[cpus[i]];
+		cpu.state = CPU_LENT;
+		cpu.lender = slot;
+		cpu.borrower = -1;
+		cpu.return_by = return_by;
+	}
+	pthread_mutex_unlock(&board->lock);
+}
+
+void withdraw_cpus(LendingBoard *board, int slot, const vector<unsigned> &cpus) {
+	pthread_mutex_lock(&board->lock);
+	for (unsigned i=0; i<cpus.size(); i++) {
+		if (cpus[i] >= kLendingMaxCpus) continue;
+		LentCpu &cpu = board->cpus[cpus[i]];
+		if (cpu.lender != slot) continue;
+		cpu.state = CPU_OWNED;
+		cpu.borrower = -1;
+	}
+	pthread_mutex_unlock(&board->lock);
+}
+
+unsigned borrow_cpus(LendingBoard *board, int slot, unsigned max_cpus, uint64_t min_duration, Loan *loans) {
+	uint64_t now = lending_now();
+	unsigned num_loans = 0;
+	pthread_mutex_lock(&board->lock);
+	while (num_loans < max_cpus) {
+		int best = -1;
+		for (unsigned c=0; c<kLendingMaxCpus; c++) {
+			const LentCpu &cpu = board->cpus[c];
+			if (cpu.state != CPU_LENT || cpu.lender == slot || cpu.return_by < now + min_duration) continue;
+			if (best < 0 || cpu.return_by > board->cpus[best].return_by) best = c;
+		}
+		if (best < 0) break;
+
+		LentCpu &cpu = board->cpus[best];
+		cpu.state = CPU_BORROWED;
+		cpu.borrower = slot;
+		loans[num_loans].cpu = best;
+		loans[num_loans].return_by = cpu.return_by;
+		num_loans++;
+	}
+	pthread_mutex_unlock(&board->lock);
+	return num_loans;
+}
+
+void return_cpus(LendingBoard *board, int slot, const Loan *loans, unsigned num_loans) {
+	pthread_mutex_lock(&board->lock);
+	for (unsigned i=0; i<num_loans; i++) {
+		LentCpu &cpu = board->cpus[loans[i].cpu];
+		if (cpu.state == CPU_BORROWED && cpu.borrower == slot) {
+			cpu.state = CPU_LENT;
+			cpu.borrower = -1;
+		}
+	}
+	pthread_mutex_unlock(&board->lock);
+}
+
+void close_lending_board(LendingBoard *board, const char *name) {
+	munmap(board, sizeof(LendingBoard));
+	if (name != NULL) {
+		shm_unlink(name);
+	}
+}
+
+void set_lending_task(LendingTask *task) {
+	thread_lending_task = task;
+}
+
+LendingTask *lending_task() {
+	return thread_lending_task;
+}
@@ -0,0 +1,102 @@
+// Lending of idle dedicated CPUs between the FS tasks of a task set, when
+// reclaiming is enabled with RT_GOMP_RECLAIM=1.
+//
+// A job usually finishes well before its deadline, and its task's CPUs then
+// sit idle until the next release. With reclaiming, the task lends them on a
+// board in shared memory until a guard time (RT_GOMP_RECLAIM_GUARD_NS, 200us
+// by default) before its next release. At the start of each segment, a task
+// whose remaining work cannot finish by the job's deadline on its own CPUs
+// (Graham's bound L + (C-L)/n of the remaining segments) borrows CPUs from the
+// board and runs strands on them with guest threads of its worker pool.
+//
+// The guests run one priority below the tasks, so the lender of a CPU
+// preempts them as soon as its next job is released, whatever happens: FS's
+// guarantee for the lender is kept. A guest only takes a strand that it can
+// finish before the CPU must be returned, so the borrower is not left waiting
+// for a strand stuck under the lender.
+//
+// The launcher creates the board and passes its name to the tasks in
+// RT_GOMP_LENDING_BOARD. Times on the board are CLOCK_MONOTONIC nanoseconds.
+
+#ifndef CORE_LENDING_H
+#define CORE_LENDING_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include <vector>
+
+const unsigned kLendingMaxCpus = 1024;
+
+// Default time before its next release at which a lender gets its CPUs back
+const uint64_t kDefaultReclaimGuard = 200000;
+
+enum Lending_State {
+	CPU_OWNED = 0, // used by its task, or not lent
+	CPU_LENT = 1, // idle and free to borrow
+	CPU_BORROWED = 2
+};
+
+// A CPU on the board, indexed by its number
+typedef struct LentCpu {
+	unsigned state; // Lending_State
+	int lender; // slot of the task lending the CPU
+	int borrower; // slot of the borrowing task
+	uint64_t return_by; // when the CPU goes back to its lender
+} LentCpu;
+
+typedef struct LendingBoard {
+	pthread_mutex_t lock; // process-shared
+	unsigned num_tasks;
+	LentCpu cpus[kLendingMaxCpus];
+} LendingBoard;
+
+// A CPU held by a borrower
+typedef struct Loan {
+	unsigned cpu;
+	uint64_t return_by;
+} Loan;
+
+// Lending state of the task run by the calling thread, set by the task
+// manager and read by the task to borrow CPUs for its job
+typedef struct LendingTask {
+	LendingBoard *board;
+	int slot;
+	uint64_t deadline; // absolute deadline of the current job, 0 between jobs
+} LendingTask;
+
+// Current time of the board's clock (ns)
+uint64_t lending_now();
+
+// Create the board @name (a POSIX shared memory name, e.g.
+// "/RT_GOMP_LENDING_BOARD") with every CPU owned. NULL on failure.
+LendingBoard *create_lending_board(const char *name);
+
+// Open the board @name created by the launcher. NULL on failure.
+LendingBoard *open_lending_board(const char *name);
+
+// Add a task to the board. Return its slot.
+int lending_join(LendingBoard *board);
+
+// Lend the CPUs @cpus of the task in @slot for @duration ns from now
+void lend_cpus(LendingBoard *board, int slot, const std::vector<unsigned> &cpus, uint64_t duration);
+
+// Take back the CPUs @cpus of the task in @slot, lent or borrowed
+void withdraw_cpus(LendingBoard *board, int slot, const std::vector<unsigned> &cpus);
+
+// Borrow up to @max_cpus lent CPUs that stay lent for at least @min_duration
+// ns, the longest lent first, for the task in @slot. Return their number.
+unsigned borrow_cpus(LendingBoard *board, int slot, unsigned max_cpus, uint64_t min_duration, Loan *loans);
+
+// Give back the borrowed CPUs that have not been withdrawn, so that other
+// tasks can borrow them
+void return_cpus(LendingBoard *board, int slot, const Loan *loans, unsigned num_loans);
+
+// Unmap the board; the creator also removes @name, if not NULL
+void close_lending_board(LendingBoard *board, const char *name);
+
+// Set or get the lending state of the task of the calling thread (NULL if
+// reclaiming is off). @task must outlive its use by the thread.
+void set_lending_task(LendingTask *task);
+LendingTask *lending_task();
+
+#endif // CORE_LENDING_H
@@ -0,0 +1,155 @@
+// EDF scheduling of the tasks of a shared core pool. See edf_pool.h.
+
+#include <fcntl.h>
+#include <sched.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include "edf_pool.h"
+
+using namespace std;
+
+static EdfPool *map_pool(int fd) {
+	void *addr = mmap(NULL, sizeof(EdfPool), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	return (addr == MAP_FAILED) ? NULL : (EdfPool*) addr;
+}
+
+EdfPool *create_edf_pool(const char *name) {
+	int fd = shm_open(name, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+	if (fd == -1) {
+		return NULL;
+	}
+	if (ftruncate(fd, sizeof(EdfPool)) != 0) {
+		close(fd);
+		shm_unlink(name);
+		return NULL;
+	}
+
+	EdfPool *pool = map_pool(fd);
+	if (pool == NULL) {
+		shm_unlink(name);
+		return NULL;
+	}
+
+	// The tasks lock the table from real-time threads of different priorities
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+	pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+	int ret_val = pthread_mutex_init(&pool->lock, &attr);
+	pthread_mutexattr_destroy(&attr);
+	if (ret_val != 0) {
+		close_edf_pool(pool, name);
+		return NULL;
+	}
+	pool->num_tasks = 0;
+	return pool;
+}
+
+EdfPool *open_edf_pool(const char *name) {
+	int fd = shm_open(name, O_RDWR, 0);
+	if (fd == -1) {
+		return NULL;
+	}
+	return map_pool(fd);
+}
+
+int edf_pool_join(EdfPool *pool) {
+	pthread_mutex_lock(&pool->lock);
+	int slot = -1;
+	if (pool->num_tasks < kEdfPoolMaxTasks) {
+		slot = pool->num_tasks++;
+		EdfPoolTask &task = pool->tasks[slot];
+		task.deadline = 0;
+		task.priority = kEdfPoolTopPriority;
+		task.num_threads = 0;
+	}
+	pthread_mutex_unlock(&pool->lock);
+	return slot;
+}
+
+bool edf_pool_add_thread(EdfPool *pool, int slot) {
+	pthread_mutex_lock(&pool->lock);
+	EdfPoolTask &task = pool->tasks[slot];
+	bool added = (task.num_threads < kEdfPoolMaxThreads);
+	if (added) {
+		task.threads[task.num_threads++] = syscall(SYS_gettid);
+	}
+	pthread_mutex_unlock(&pool->lock);
+	return added;
+}
+
+static void set_task_priority(EdfPoolTask &task, int priority) {
+	if (task.priority == priority) return;
+	task.priority = priority;
+
+	sched_param sp;
+	sp.sched_priority = priority;
+	for (unsigned i=0; i<task.num_threads; i++) {
+		sched_setparam(task.threads[i], &sp);
+	}
+}
+
+// Give the active jobs their priorities in the EDF order, breaking ties by
+// slot, and the top priority to the tasks without an active job.
+// Must be called with the lock held.
+static void reorder_jobs(EdfPool *pool) {
+	unsigned order[kEdfPoolMaxTasks];
+	unsigned num_active = 0;
+	for (unsigned i=0; i<pool->num_tasks; i++) {
+		if (pool->tasks[i].deadline != 0) order[num_active++] = i;
+	}
+	const EdfPoolTask *tasks = pool->tasks;
+	sort(order, order + num_active, [tasks](unsigned a, unsigned b) {
+		if (tasks[a].deadline != tasks[b].deadline) return tasks[a].deadline < tasks[b].deadline;
+		return a < b;
+	});
+
+	// Lower the jobs that move down first, so that a job later in the new
+	// order is never above an earlier one while the priorities change
+	for (unsigned k=num_active; k>0; k--) {
+		int priority = max(kEdfPoolTopPriority - (int)k, 1);
+		if (pool->tasks[order[k-1]].priority > priority) {
+			set_task_priority(pool->tasks[order[k-1]], priority);
+		}
+	}
+	for (unsigned k=0; k<num_active; k++) {
+		set_task_priority(pool->tasks[order[k]], max(kEdfPoolTopPriority - (int)(k+1), 1));
+	}
+	for (unsigned i=0; i<pool->num_tasks; i++) {
+		if (pool->tasks[i].deadline == 0) set_task_priority(pool->tasks[i], kEdfPoolTopPriority);
+	}
+}
+
+void edf_pool_job_start(EdfPool *pool, int slot, uint64_t deadline) {
+	pthread_mutex_lock(&pool->lock);
+	pool->tasks[slot].deadline = (deadline != 0) ? deadline : 1;
+	reorder_jobs(pool);
+	pthread_mutex_unlock(&pool->lock);
+}
+
+void edf_pool_job_finish(EdfPool *pool, int slot) {
+	pthread_mutex_lock(&pool->lock);
+	pool->tasks[slot].deadline = 0;
+	reorder_jobs(pool);
+	pthread_mutex_unlock(&pool->lock);
+}
+
+void edf_pool_leave(EdfPool *pool, int slot) {
+	pthread_mutex_lock(&pool->lock);
+	pool->tasks[slot].deadline = 0;
+	pool->tasks[slot].num_threads = 0;
+	reorder_jobs(pool);
+	pthread_mutex_unlock(&pool->lock);
+}
+
+void close_edf_pool(EdfPool *pool, const char *name) {
+	munmap(pool, sizeof(EdfPool));
+	if (name != NULL) {
+		shm_unlink(name);
+	}
+}
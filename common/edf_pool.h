@@ -0,0 +1,74 @@
+// EDF scheduling of the tasks that share the core pool of a hybrid
+// (semi-federated) partition, see fs/partition.h.
+//
+// Linux provides EDF as SCHED_DEADLINE, but its admission control needs the
+// affinity of a task to span a whole root domain, so it cannot schedule a
+// pool of cores inside the machine without repartitioning the cpusets.
+// Instead, the pool tasks keep SCHED_FIFO and share a table in shared memory
+// with the absolute deadline of each task's active job and the thread ids of
+// its OpenMP team. When a job starts or finishes, its task updates the table
+// and gives the active jobs priorities in the order of their deadlines, the
+// earliest highest, to all the threads of their teams. Since the EDF order
+// only changes at these events, the pool runs global EDF at the granularity
+// of jobs, at the cost of one sched_setparam per thread whose priority changes.
+//
+// A task without an active job has the top priority of the pool, so that
+// its next job starts and takes its place in the order as soon as it is
+// released. The launcher creates the table and passes its name to the pool
+// tasks in RT_GOMP_EDF_POOL.
+
+#ifndef EDF_POOL_H
+#define EDF_POOL_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/types.h>
+
+const unsigned kEdfPoolMaxTasks = 64;
+const unsigned kEdfPoolMaxThreads = 256;
+
+// Priority of the pool tasks without an active job. The active jobs get the
+// priorities below it, one per rank in the EDF order (at least 1).
+const int kEdfPoolTopPriority = 97;
+
+// A task of the pool
+typedef struct EdfPoolTask {
+	uint64_t deadline; // absolute deadline of the active job (ns), 0 if none
+	int priority; // current priority of the task's threads
+	unsigned num_threads;
+	pid_t threads[kEdfPoolMaxThreads];
+} EdfPoolTask;
+
+typedef struct EdfPool {
+	pthread_mutex_t lock; // process-shared, with priority inheritance
+	unsigned num_tasks;
+	EdfPoolTask tasks[kEdfPoolMaxTasks];
+} EdfPool;
+
+// Create the shared table @name (a POSIX shared memory name, e.g.
+// "/RT_GOMP_EDF_POOL") without any task. NULL on failure.
+EdfPool *create_edf_pool(const char *name);
+
+// Open the shared table @name created by the launcher. NULL on failure.
+EdfPool *open_edf_pool(const char *name);
+
+// Add a task to the pool. Return its slot, or -1 if the pool is full.
+int edf_pool_join(EdfPool *pool);
+
+// Add the calling thread to the threads of the task in @slot. It must already
+// have SCHED_FIFO and the top priority of the pool. Return false if the task
+// has too many threads.
+bool edf_pool_add_thread(EdfPool *pool, int slot);
+
+// The job of the task in @slot with absolute deadline @deadline (ns) starts,
+// or the active job of the task finishes: reorder the active jobs
+void edf_pool_job_start(EdfPool *pool, int slot, uint64_t deadline);
+void edf_pool_job_finish(EdfPool *pool, int slot);
+
+// Remove the threads of the task in @slot, e.g., when it exits
+void edf_pool_leave(EdfPool *pool, int slot);
+
+// Unmap the table; the creator also removes @name, if not NULL
+void close_edf_pool(EdfPool *pool, const char *name);
+
+#endif // EDF_POOL_H
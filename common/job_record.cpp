@@ -0,0 +1,232 @@
+// Compact binary file of per-job timings. See job_record.h for the layout.
+
+#define __STDC_FORMAT_MACROS
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "job_record.h"
+
+using namespace std;
+
+static const char kMagic[4] = {'R', 'T', 'J', 'R'};
+
+static void put_le(uint8_t *buf, uint64_t value, unsigned bytes) {
+	for (unsigned i=0; i<bytes; i++) {
+		buf[i] = (uint8_t)(value >> (8*i));
+	}
+}
+
+static uint64_t get_le(const uint8_t *buf, unsigned bytes) {
+	uint64_t value = 0;
+	for (unsigned i=0; i<bytes; i++) {
+		value |= (uint64_t)buf[i] << (8*i);
+	}
+	return value;
+}
+
+// Append an unsigned value as a varint (7 bits per byte, low bits first)
+static void put_varint(vector<uint8_t> &out, uint64_t value) {
+	while (value >= 0x80) {
+		out.push_back((uint8_t)(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back((uint8_t)value);
+}
+
+// Read a varint at pos. Return false if it runs past the end.
+static bool get_varint(const uint8_t *data, size_t size, size_t &pos, uint64_t &value) {
+	value = 0;
+	for (unsigned shift=0; shift<64; shift+=7) {
+		if (pos >= size) return false;
+		uint8_t byte = data[pos++];
+		value |= (uint64_t)(byte & 0x7f) << shift;
+		if (!(byte & 0x80)) return true;
+	}
+	return false;
+}
+
+// Map signed differences to unsigned values so that small magnitudes stay small
+static uint64_t zigzag(int64_t value) {
+	return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t unzigzag(uint64_t value) {
+	return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+bool write_job_records(const char *path, JobRecordHeader header, const uint64_t *values) {
+	// The first job's fields are stored as differences to 0
+	vector<uint8_t> payload;
+	payload.reserve((size_t)header.num_jobs * header.num_fields * 3);
+	for (uint32_t i=0; i<header.num_jobs; i++) {
+		for (uint32_t f=0; f<header.num_fields; f++) {
+			uint64_t value = values[(size_t)i*header.num_fields + f];
+			uint64_t prev = (i == 0) ? 0 : values[(size_t)(i-1)*header.num_fields + f];
+			put_varint(payload, zigzag((int64_t)(value - prev)));
+		}
+	}
+
+	header.version = kJobRecordVersion;
+	header.payload_size = payload.size();
+
+	uint8_t buf[kJobRecordHeaderSize];
+	memset(buf, 0, sizeof(buf));
+	memcpy(buf, kMagic, 4);
+	put_le(buf + 4, header.version, 2);
+	buf[6] = header.scheduler;
+	put_le(buf + 8, header.task_id, 4);
+	put_le(buf + 12, header.num_jobs, 4);
+	put_le(buf + 16, header.num_fields, 4);
+	put_le(buf + 24, header.period, 8);
+	put_le(buf + 32, header.deadline, 8);
+	put_le(buf + 40, header.payload_size, 8);
+
+	FILE *fp = fopen(path, "wb");
+	if (fp == NULL) {
+		return false;
+	}
+	bool ok = (fwrite(buf, 1, sizeof(buf), fp) == sizeof(buf)) &&
+		(payload.empty() || fwrite(&payload[0], 1, payload.size(), fp) == payload.size());
+	ok = (fclose(fp) == 0) && ok;
+	return ok;
+}
+
+bool open_job_records(const char *path, JobRecordReader &reader) {
+	reader.fd = -1;
+	reader.data = NULL;
+	reader.size = 0;
+
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || (size_t)st.st_size < kJobRecordHeaderSize) {
+		close(fd);
+		return false;
+	}
+
+	void *addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (addr == MAP_FAILED) {
+		close(fd);
+		return false;
+	}
+
+	reader.fd = fd;
+	reader.data = (const uint8_t*)addr;
+	reader.size = st.st_size;
+
+	const uint8_t *buf = reader.data;
+	JobRecordHeader &header = reader.header;
+	header.version = get_le(buf + 4, 2);
+	header.scheduler = buf[6];
+	header.task_id = get_le(buf + 8, 4);
+	header.num_jobs = get_le(buf + 12, 4);
+	header.num_fields = get_le(buf + 16, 4);
+	header.period = get_le(buf + 24, 8);
+	header.deadline = get_le(buf + 32, 8);
+	header.payload_size = get_le(buf + 40, 8);
+
+	if (memcmp(buf, kMagic, 4) != 0 || header.version == 0 || header.num_fields == 0 ||
+		header.payload_size > reader.size - kJobRecordHeaderSize) {
+		close_job_records(reader);
+		return false;
+	}
+	return true;
+}
+
+bool read_job_records(const JobRecordReader &reader, vector<uint64_t> &values) {
+	const JobRecordHeader &header = reader.header;
+	const uint8_t *payload = reader.data + kJobRecordHeaderSize;
+	size_t size = header.payload_size;
+	size_t pos = 0;
+
+	values.resize((size_t)header.num_jobs * header.num_fields);
+	for (uint32_t i=0; i<header.num_jobs; i++) {
+		for (uint32_t f=0; f<header.num_fields; f++) {
+			uint64_t encoded;
+			if (!get_varint(payload, size, pos, encoded)) return false;
+			uint64_t prev = (i == 0) ? 0 : values[(size_t)(i-1)*header.num_fields + f];
+			values[(size_t)i*header.num_fields + f] = prev + (uint64_t)unzigzag(encoded);
+		}
+	}
+	return true;
+}
+
+bool read_job_field(const JobRecordReader &reader, unsigned field, vector<uint64_t> &values) {
+	const JobRecordHeader &header = reader.header;
+	if (field >= header.num_fields) return false;
+
+	const uint8_t *payload = reader.data + kJobRecordHeaderSize;
+	size_t size = header.payload_size;
+	size_t pos = 0;
+	uint64_t prev = 0;
+
+	values.resize(header.num_jobs);
+	for (uint32_t i=0; i<header.num_jobs; i++) {
+		for (uint32_t f=0; f<header.num_fields; f++) {
+			uint64_t encoded;
+			if (!get_varint(payload, size, pos, encoded)) return false;
+			if (f == field) {
+				prev += (uint64_t)unzigzag(encoded);
+				values[i] = prev;
+			}
+		}
+	}
+	return true;
+}
+
+void close_job_records(JobRecordReader &reader) {
+	if (reader.data != NULL) {
+		munmap((void*)reader.data, reader.size);
+		reader.data = NULL;
+	}
+	if (reader.fd >= 0) {
+		close(reader.fd);
+		reader.fd = -1;
+	}
+}
+
+void fill_job_record(uint64_t *fields, uint64_t release, uint64_t start, uint64_t finish, uint64_t deadline) {
+	fields[JOB_RESPONSE_TIME] = finish - start;
+	fields[JOB_RELEASE] = release;
+	fields[JOB_START] = start;
+	fields[JOB_FINISH] = finish;
+	fields[JOB_RELEASE_LATENCY] = (start > release) ? start - release : 0;
+	fields[JOB_RELEASE_RESPONSE_TIME] = (finish > release) ? finish - release : 0;
+	fields[JOB_TARDINESS] = (finish > release + deadline) ? finish - release - deadline : 0;
+}
+
+void init_job_summary(JobRecordSummary &summary) {
+	memset(&summary, 0, sizeof(summary));
+}
+
+void job_summary_add(JobRecordSummary &summary, const uint64_t *fields) {
+	for (unsigned f=0; f<kJobRecordFields; f++) {
+		if (fields[f] > summary.max[f]) summary.max[f] = fields[f];
+		summary.sum[f] += fields[f];
+	}
+	summary.num_jobs++;
+}
+
+bool write_job_summary(const char *path, const char *task_name, const JobRecordSummary &summary) {
+	FILE *fp = fopen(path, "w");
+	if (fp == NULL) {
+		return false;
+	}
+
+	const unsigned fields[] = {JOB_RELEASE_LATENCY, JOB_RELEASE_RESPONSE_TIME, JOB_TARDINESS};
+	const char *names[] = {"release latency", "response time from release", "tardiness"};
+	unsigned num_jobs = (summary.num_jobs == 0) ? 1 : summary.num_jobs;
+
+	for (unsigned i=0; i<sizeof(fields)/sizeof(fields[0]); i++) {
+		fprintf(fp, "Max %s for task %s: %" PRIu64 " nsec\n", names[i], task_name, summary.max[fields[i]]);
+		fprintf(fp, "Avg %s for task %s: %" PRIu64 " nsec\n", names[i], task_name, summary.sum[fields[i]]/num_jobs);
+	}
+	return (fclose(fp) == 0);
+}
@@ -0,0 +1,102 @@
+// Compact binary file of per-job timings recorded by a task (.jobs file).
+//
+// Layout (all integers little-endian):
+//   header (kJobRecordHeaderSize bytes):
+//     magic "RTJR", version (u16), scheduler (u8), reserved (u8),
+//     task id (u32), number of jobs (u32), number of fields per job (u32),
+//     period in ns (u64), relative deadline in ns (u64), payload size in bytes (u64)
+//   payload: for each job, for each field, the difference to the same field
+//     of the previous job (0 for the first job), zigzag and varint encoded.
+// Version 1 has a single field per job: the job's response time in ns.
+// Version 2 has the kJobRecordFields fields of Job_Record_Field, the first
+// of which is still the response time. Readers must use the number of fields
+// from the header, since later versions append more fields per job.
+
+#ifndef JOB_RECORD_H
+#define JOB_RECORD_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <vector>
+
+const uint16_t kJobRecordVersion = 2;
+const size_t kJobRecordHeaderSize = 48;
+
+// The scheduler under which the jobs ran
+enum Job_Record_Scheduler {
+	JOB_RECORD_FS = 0,
+	JOB_RECORD_GEDF = 1
+};
+
+// Fields of a job (version 2), in ns. Times are absolute, on the clock of
+// get_time; the intended release is the start of the job's period.
+enum Job_Record_Field {
+	JOB_RESPONSE_TIME = 0, // from the actual start to the finish
+	JOB_RELEASE = 1, // intended release
+	JOB_START = 2, // actual start
+	JOB_FINISH = 3,
+	JOB_RELEASE_LATENCY = 4, // from the intended release to the actual start
+	JOB_RELEASE_RESPONSE_TIME = 5, // from the intended release to the finish
+	JOB_TARDINESS = 6 // time past the deadline of the intended release, 0 if met
+};
+const unsigned kJobRecordFields = 7;
+
+typedef struct JobRecordHeader {
+	uint16_t version;
+	uint8_t scheduler;
+	uint32_t task_id;
+	uint32_t num_jobs;
+	uint32_t num_fields;
+	uint64_t period;
+	uint64_t deadline;
+	uint64_t payload_size;
+} JobRecordHeader;
+
+// Encode the values (num_jobs x num_fields, job after job) and write them
+// with the header to a file. The payload size in the header is filled in.
+// Return false on failure.
+bool write_job_records(const char *path, JobRecordHeader header, const uint64_t *values);
+
+// A .jobs file mapped in memory for reading
+typedef struct JobRecordReader {
+	int fd;
+	const uint8_t *data;
+	size_t size;
+	JobRecordHeader header;
+} JobRecordReader;
+
+// Map a .jobs file and read its header. Return false if the file cannot be
+// opened or is not a valid job record file.
+bool open_job_records(const char *path, JobRecordReader &reader);
+
+// Decode all values of the file (num_jobs x num_fields, job after job)
+bool read_job_records(const JobRecordReader &reader, std::vector<uint64_t> &values);
+
+// Decode a single field of every job, e.g., field 0 for the response times
+bool read_job_field(const JobRecordReader &reader, unsigned field, std::vector<uint64_t> &values);
+
+// Unmap the file
+void close_job_records(JobRecordReader &reader);
+
+// Fill the kJobRecordFields fields of a job from its intended release, actual
+// start and finish times, and the task's relative deadline
+void fill_job_record(uint64_t *fields, uint64_t release, uint64_t start, uint64_t finish, uint64_t deadline);
+
+// Maximum and sum of each field over a task's jobs, for its summary file
+typedef struct JobRecordSummary {
+	uint64_t max[kJobRecordFields];
+	uint64_t sum[kJobRecordFields];
+	unsigned num_jobs;
+} JobRecordSummary;
+
+void init_job_summary(JobRecordSummary &summary);
+void job_summary_add(JobRecordSummary &summary, const uint64_t *fields);
+
+// Write the maximum and average release latency, response time from the
+// intended release and tardiness, one line each, to a summary file (.summary,
+// text), kept apart from the output file so that its format is unchanged.
+// Return false on failure.
+bool write_job_summary(const char *path, const char *task_name, const JobRecordSummary &summary);
+
+#endif // JOB_RECORD_H
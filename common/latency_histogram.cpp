@@ -0,0 +1,157 @@
+// Bounded-memory histogram of response times. See latency_histogram.h.
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <cmath>
+#include "latency_histogram.h"
+
+using namespace std;
+
+const unsigned kHalfSubBuckets = kHistogramSubBuckets/2;
+
+// Buckets 0 .. (64 - kHistogramSubBucketBits), the first one with all sub-buckets
+const unsigned kNumBucketIndexes = (64 - kHistogramSubBucketBits)*kHalfSubBuckets + kHistogramSubBuckets;
+
+// Position of the most significant bit, value must be non-zero
+static unsigned msb(uint64_t value) {
+	return 63 - __builtin_clzll(value);
+}
+
+// Values below kHistogramSubBuckets have their own index. Above, a value with
+// its most significant bit at position p goes to the sub-bucket given by its
+// kHistogramSubBucketBits highest bits, in power-of-two bucket p-bits+1.
+static unsigned index_of(uint64_t value) {
+	if (value < kHistogramSubBuckets) return value;
+	unsigned bucket = msb(value) - kHistogramSubBucketBits + 1;
+	return bucket*kHalfSubBuckets + (unsigned)(value >> bucket);
+}
+
+// The largest value that falls in the bucket with the given index
+static uint64_t highest_value_of(unsigned index) {
+	if (index < kHistogramSubBuckets) return index;
+	unsigned bucket = index/kHalfSubBuckets - 1;
+	uint64_t sub_bucket = index - bucket*kHalfSubBuckets;
+	return ((sub_bucket + 1) << bucket) - 1;
+}
+
+void init_histogram(LatencyHistogram &hist) {
+	hist.counts.assign(kNumBucketIndexes, 0);
+	hist.total_count = 0;
+	hist.min = UINT64_MAX;
+	hist.max = 0;
+	hist.sum = 0;
+}
+
+void histogram_record(LatencyHistogram &hist, uint64_t value, uint64_t count) {
+	if (count == 0) return;
+	hist.counts[index_of(value)] += count;
+	hist.total_count += count;
+	hist.sum += value*count;
+	if (value < hist.min) hist.min = value;
+	if (value > hist.max) hist.max = value;
+}
+
+void histogram_merge(LatencyHistogram &dst, const LatencyHistogram &src) {
+	if (src.total_count == 0) return;
+	for (unsigned i=0; i<kNumBucketIndexes; i++) {
+		dst.counts[i] += src.counts[i];
+	}
+	dst.total_count += src.total_count;
+	dst.sum += src.sum;
+	if (src.min < dst.min) dst.min = src.min;
+	if (src.max > dst.max) dst.max = src.max;
+}
+
+static uint64_t scale(uint64_t value, uint64_t num, uint64_t den) {
+	return (uint64_t)((long double)value*num/den + 0.5);
+}
+
+void histogram_merge_scaled(LatencyHistogram &dst, const LatencyHistogram &src, uint64_t num, uint64_t den) {
+	if (src.total_count == 0) return;
+	uint64_t sum = dst.sum;
+	for (unsigned i=0; i<kNumBucketIndexes; i++) {
+		if (src.counts[i] == 0) continue;
+		// Values are the highest of their bucket, as for the quantiles
+		uint64_t value = highest_value_of(i);
+		if (value > src.max) value = src.max;
+		histogram_record(dst, scale(value, num, den), src.counts[i]);
+	}
+	dst.sum = sum + scale(src.sum, num, den);
+	dst.min = min(dst.min, scale(src.min, num, den));
+	dst.max = max(dst.max, scale(src.max, num, den));
+}
+
+uint64_t histogram_value_at_quantile(const LatencyHistogram &hist, double quantile) {
+	if (hist.total_count == 0) return 0;
+	if (quantile >= 1.0) return hist.max;
+
+	uint64_t rank = (uint64_t)ceil(quantile*hist.total_count);
+	if (rank == 0) rank = 1;
+
+	uint64_t seen = 0;
+	for (unsigned i=0; i<kNumBucketIndexes; i++) {
+		seen += hist.counts[i];
+		if (seen >= rank) {
+			uint64_t value = highest_value_of(i);
+			return (value < hist.max) ? value : hist.max;
+		}
+	}
+	return hist.max;
+}
+
+double histogram_mean(const LatencyHistogram &hist) {
+	if (hist.total_count == 0) return 0;
+	return (double)hist.sum/hist.total_count;
+}
+
+bool write_histogram(const string &path, const LatencyHistogram &hist) {
+	FILE *fp = fopen(path.c_str(), "w");
+	if (fp == NULL) {
+		return false;
+	}
+
+	uint64_t min = (hist.total_count == 0) ? 0 : hist.min;
+	fprintf(fp, "RTHIST %u %u %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64 "\n", kHistogramVersion,
+			kHistogramSubBucketBits, hist.total_count, min, hist.max, hist.sum);
+	for (unsigned i=0; i<kNumBucketIndexes; i++) {
+		if (hist.counts[i] != 0) {
+			fprintf(fp, "%u %" PRIu64 "\n", i, hist.counts[i]);
+		}
+	}
+	return (fclose(fp) == 0);
+}
+
+bool read_histogram(const string &path, LatencyHistogram &hist) {
+	FILE *fp = fopen(path.c_str(), "r");
+	if (fp == NULL) {
+		return false;
+	}
+
+	init_histogram(hist);
+	unsigned version, bits;
+	uint64_t total_count, min, max, sum;
+	if (fscanf(fp, "RTHIST %u %u %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64, &version, &bits,
+			   &total_count, &min, &max, &sum) != 6 ||
+		version != kHistogramVersion || bits != kHistogramSubBucketBits) {
+		fclose(fp);
+		return false;
+	}
+
+	unsigned index;
+	uint64_t count, read_count = 0;
+	while (fscanf(fp, "%u %" SCNu64, &index, &count) == 2) {
+		if (index >= kNumBucketIndexes) break;
+		hist.counts[index] += count;
+		read_count += count;
+	}
+	fclose(fp);
+
+	if (read_count != total_count) {
+		return false;
+	}
+	hist.total_count = total_count;
+	hist.min = (total_count == 0) ? UINT64_MAX : min;
+	hist.max = max;
+	hist.sum = sum;
+	return true;
+}
@@ -0,0 +1,61 @@
+// Bounded-memory histogram of response times (in ns or any other unsigned
+// integer unit), in the style of an HDR histogram: values are grouped in
+// buckets whose width doubles with each power of two, and each power of two
+// is split into kHistogramSubBuckets/2 equal sub-buckets. The relative error
+// of a reported value is thus at most 2/kHistogramSubBuckets (under 0.8%),
+// and the memory does not depend on the number of recorded values.
+// Histograms of the same unit can be merged by adding their counts.
+//
+// File format (.hist, text):
+//   RTHIST <version> <sub-bucket bits> <total count> <min> <max> <sum>
+// followed by one line "<bucket index> <count>" per non-empty bucket.
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+const unsigned kHistogramSubBucketBits = 8;
+const unsigned kHistogramSubBuckets = 1 << kHistogramSubBucketBits;
+const unsigned kHistogramVersion = 1;
+
+typedef struct LatencyHistogram {
+	std::vector<uint64_t> counts;
+	uint64_t total_count;
+	uint64_t min;
+	uint64_t max;
+	uint64_t sum;
+} LatencyHistogram;
+
+// Allocate the buckets and clear the histogram
+void init_histogram(LatencyHistogram &hist);
+
+// Record @count occurrences of @value
+void histogram_record(LatencyHistogram &hist, uint64_t value, uint64_t count = 1);
+
+// Add the counts of @src to @dst
+void histogram_merge(LatencyHistogram &dst, const LatencyHistogram &src);
+
+// Add the counts of @src to @dst with every value multiplied by @num/@den,
+// e.g., to merge response times in ns of tasks with different deadlines as
+// response times normalized by the deadlines (num = 10^6, den = deadline).
+void histogram_merge_scaled(LatencyHistogram &dst, const LatencyHistogram &src, uint64_t num, uint64_t den);
+
+// The smallest recorded value (up to the bucket precision) such that
+// a fraction @quantile of the recorded values are not larger.
+// The maximum is reported exactly. Return 0 for an empty histogram.
+uint64_t histogram_value_at_quantile(const LatencyHistogram &hist, double quantile);
+
+// Return 0 for an empty histogram
+double histogram_mean(const LatencyHistogram &hist);
+
+// Write the histogram to a .hist file. Return false on failure.
+bool write_histogram(const std::string &path, const LatencyHistogram &hist);
+
+// Read a histogram from a .hist file. Return false if the file cannot be
+// opened or is not a valid histogram file.
+bool read_histogram(const std::string &path, LatencyHistogram &hist);
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,66 @@
+// Overhead profile of the experiment harness. See overhead_profile.h.
+
+#include <stdio.h>
+#include <fstream>
+#include <sstream>
+#include "overhead_profile.h"
+
+using namespace std;
+
+OverheadEntry make_overhead_entry(const string &name, const string &unit, const LatencyHistogram &hist) {
+	OverheadEntry entry;
+	entry.name = name;
+	entry.unit = unit;
+	entry.samples = hist.total_count;
+	entry.mean = histogram_mean(hist);
+	entry.p50 = histogram_value_at_quantile(hist, 0.5);
+	entry.p90 = histogram_value_at_quantile(hist, 0.9);
+	entry.p99 = histogram_value_at_quantile(hist, 0.99);
+	entry.p999 = histogram_value_at_quantile(hist, 0.999);
+	entry.max = histogram_value_at_quantile(hist, 1.0);
+	return entry;
+}
+
+const OverheadEntry *find_overhead_entry(const vector<OverheadEntry> &profile, const string &name) {
+	for (unsigned i=0; i<profile.size(); i++) {
+		if (profile[i].name == name) return &profile[i];
+	}
+	return NULL;
+}
+
+bool write_overhead_profile(const string &path, const vector<OverheadEntry> &profile) {
+	FILE *fp = fopen(path.c_str(), "w");
+	if (fp == NULL) {
+		return false;
+	}
+
+	fprintf(fp, "# name unit samples mean p50 p90 p99 p99.9 max\n");
+	for (unsigned i=0; i<profile.size(); i++) {
+		const OverheadEntry &entry = profile[i];
+		fprintf(fp, "%s %s %llu %.1f %.0f %.0f %.0f %.0f %.0f\n", entry.name.c_str(), entry.unit.c_str(),
+				(unsigned long long)entry.samples, entry.mean, entry.p50, entry.p90, entry.p99, entry.p999, entry.max);
+	}
+	return (fclose(fp) == 0);
+}
+
+bool read_overhead_profile(const string &path, vector<OverheadEntry> &profile) {
+	ifstream ifs(path.c_str());
+	if (!ifs.is_open()) {
+		return false;
+	}
+
+	profile.clear();
+	string line;
+	while (getline(ifs, line)) {
+		if (line.empty() || line[0] == '#') continue;
+
+		OverheadEntry entry;
+		istringstream line_stream(line);
+		if (!(line_stream >> entry.name >> entry.unit >> entry.samples >> entry.mean >> entry.p50
+			  >> entry.p90 >> entry.p99 >> entry.p999 >> entry.max)) {
+			return false;
+		}
+		profile.push_back(entry);
+	}
+	return true;
+}
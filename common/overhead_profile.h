@@ -0,0 +1,40 @@
+// Overhead profile of the experiment harness on a machine, as measured by
+// fs/overhead_bench: one distribution per measured operation.
+//
+// File format (text): comment lines start with #, then one line per entry:
+//   <name> <unit> <samples> <mean> <p50> <p90> <p99> <p99.9> <max>
+// The unit is "ns" for durations, or "ppm" for ratios in millionths.
+
+#ifndef OVERHEAD_PROFILE_H
+#define OVERHEAD_PROFILE_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "latency_histogram.h"
+
+typedef struct OverheadEntry {
+	std::string name;
+	std::string unit;
+	uint64_t samples;
+	double mean;
+	double p50;
+	double p90;
+	double p99;
+	double p999;
+	double max;
+} OverheadEntry;
+
+// Summarize a histogram of measurements as an entry
+OverheadEntry make_overhead_entry(const std::string &name, const std::string &unit, const LatencyHistogram &hist);
+
+// Return the entry with the given name, or NULL if there is none
+const OverheadEntry *find_overhead_entry(const std::vector<OverheadEntry> &profile, const std::string &name);
+
+// Write a profile. Return false on failure.
+bool write_overhead_profile(const std::string &path, const std::vector<OverheadEntry> &profile);
+
+// Read a profile. Return false if the file cannot be opened or has a malformed line.
+bool read_overhead_profile(const std::string &path, std::vector<OverheadEntry> &profile);
+
+#endif // OVERHEAD_PROFILE_H
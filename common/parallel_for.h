@@ -0,0 +1,42 @@
+// A minimal pool of worker threads to process independent items in parallel,
+// e.g., all task set files of an experiment directory.
+
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <thread>
+#include <atomic>
+#include <vector>
+
+// Return the number of worker threads to use when the user does not specify one
+inline unsigned default_num_workers() {
+	unsigned n = std::thread::hardware_concurrency();
+	return (n == 0) ? 1 : n;
+}
+
+// Call func(i) for every i in [0, count) using @num_workers threads.
+// Items are handed out one at a time from a shared counter, so that
+// workers that get cheap items move on to the next ones right away.
+// func must be safe to call concurrently for different items.
+template <typename Func>
+void parallel_for(unsigned count, unsigned num_workers, Func func) {
+	if (num_workers == 0) num_workers = default_num_workers();
+	if (num_workers > count) num_workers = count;
+
+	std::atomic<unsigned> next(0);
+	std::vector<std::thread> workers;
+	for (unsigned w=0; w<num_workers; w++) {
+		workers.push_back(std::thread([&next, count, &func]() {
+			unsigned i;
+			while ((i = next.fetch_add(1)) < count) {
+				func(i);
+			}
+		}));
+	}
+
+	for (unsigned w=0; w<workers.size(); w++) {
+		workers[w].join();
+	}
+}
+
+#endif // PARALLEL_FOR_H
@@ -0,0 +1,212 @@
+// Per-job hardware and scheduler counters of a task. See perf_counters.h.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <fstream>
+#include <sstream>
+#include "perf_counters.h"
+
+using namespace std;
+
+const char *const kPerfCounterNames[kPerfCounters] = {
+	"cycles", "instructions", "llc_misses", "context_switches", "cpu_migrations"
+};
+
+static const uint32_t kCounterTypes[kPerfCounters] = {
+	PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_SOFTWARE, PERF_TYPE_SOFTWARE
+};
+
+static const uint64_t kCounterConfigs[kPerfCounters] = {
+	PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+	PERF_COUNT_SW_CONTEXT_SWITCHES, PERF_COUNT_SW_CPU_MIGRATIONS
+};
+
+// Count the calling thread on any CPU, in the group of @group_fd (-1 for a leader)
+static int open_counter(unsigned counter, int group_fd) {
+	perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = kCounterTypes[counter];
+	attr.config = kCounterConfigs[counter];
+	attr.read_format = PERF_FORMAT_GROUP;
+	attr.exclude_hv = 1;
+
+	// The context switches happen in the kernel, so it cannot be excluded
+	return syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+static void close_group(ThreadPerfGroup &group) {
+	for (unsigned c=0; c<kPerfCounters; c++) {
+		if (group.fds[c] != -1) {
+			close(group.fds[c]);
+		}
+		group.fds[c] = -1;
+		group.position[c] = -1;
+	}
+	group.leader_fd = -1;
+}
+
+bool init_perf_counters(PerfCounters &counters, unsigned num_threads) {
+	counters.num_threads = 0;
+	counters.groups = NULL;
+	counters.partial = false;
+
+	void *groups;
+	if (num_threads == 0 || posix_memalign(&groups, 64, num_threads * sizeof(ThreadPerfGroup)) != 0) {
+		return false;
+	}
+	counters.groups = (ThreadPerfGroup*) groups;
+	counters.num_threads = num_threads;
+
+	for (unsigned i=0; i<num_threads; i++) {
+		ThreadPerfGroup &group = counters.groups[i];
+		group.leader_fd = -1;
+		for (unsigned c=0; c<kPerfCounters; c++) {
+			group.fds[c] = -1;
+			group.position[c] = -1;
+		}
+	}
+	return true;
+}
+
+bool open_thread_perf_counters(PerfCounters &counters, unsigned thread) {
+	if (thread >= counters.num_threads) {
+		return false;
+	}
+
+	ThreadPerfGroup &group = counters.groups[thread];
+	close_group(group);
+
+	// The first counter that opens leads the group, the values of a group
+	// read come in the order the counters were opened
+	int num_open = 0;
+	for (unsigned c=0; c<kPerfCounters; c++) {
+		int fd = open_counter(c, group.leader_fd);
+		if (fd == -1) {
+			continue;
+		}
+		if (group.leader_fd == -1) {
+			group.leader_fd = fd;
+		}
+		group.fds[c] = fd;
+		group.position[c] = num_open++;
+	}
+	return (num_open > 0);
+}
+
+bool perf_counter_available(const PerfCounters &counters, unsigned counter) {
+	if (counters.num_threads == 0) {
+		return false;
+	}
+	for (unsigned i=0; i<counters.num_threads; i++) {
+		if (counters.groups[i].position[counter] == -1) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void read_perf_counters(const PerfCounters &counters, uint64_t values[kPerfCounters]) {
+	memset(values, 0, kPerfCounters * sizeof(uint64_t));
+
+	// Number of counters, then their values
+	uint64_t buffer[1 + kPerfCounters];
+	for (unsigned i=0; i<counters.num_threads; i++) {
+		const ThreadPerfGroup &group = counters.groups[i];
+		if (group.leader_fd == -1 || read(group.leader_fd, buffer, sizeof(buffer)) < (ssize_t)sizeof(uint64_t)) {
+			continue;
+		}
+		for (unsigned c=0; c<kPerfCounters; c++) {
+			int position = group.position[c];
+			if (position != -1 && (uint64_t)position < buffer[0]) {
+				values[c] += buffer[1 + position];
+			}
+		}
+	}
+}
+
+bool write_perf_counters(const char *path, const PerfCounters &counters, uint64_t deadline,
+						 unsigned num_jobs, const uint64_t *response_times, const uint64_t *values) {
+	FILE *fp = fopen(path, "w");
+	if (fp == NULL) {
+		return false;
+	}
+
+	bool available[kPerfCounters];
+	fprintf(fp, "# deadline_ns %" PRIu64 " threads %u\n", deadline, counters.num_threads);
+	if (counters.partial) {
+		fprintf(fp, "# partial: only the master thread is counted, not the workers of the worker pool\n");
+	}
+	fprintf(fp, "# job response_ns");
+	for (unsigned c=0; c<kPerfCounters; c++) {
+		available[c] = perf_counter_available(counters, c);
+		fprintf(fp, " %s", kPerfCounterNames[c]);
+	}
+	fprintf(fp, "\n");
+
+	for (unsigned i=0; i<num_jobs; i++) {
+		fprintf(fp, "%u %" PRIu64, i, response_times[i]);
+		for (unsigned c=0; c<kPerfCounters; c++) {
+			if (available[c]) {
+				fprintf(fp, " %" PRIu64, values[i * kPerfCounters + c]);
+			} else {
+				fprintf(fp, " -1");
+			}
+		}
+		fprintf(fp, "\n");
+	}
+	return (fclose(fp) == 0);
+}
+
+void free_perf_counters(PerfCounters &counters) {
+	if (counters.groups != NULL) {
+		for (unsigned i=0; i<counters.num_threads; i++) {
+			close_group(counters.groups[i]);
+		}
+		free(counters.groups);
+		counters.groups = NULL;
+	}
+	counters.num_threads = 0;
+}
+
+bool read_perf_file(const string &path, uint64_t &deadline, bool &partial, vector<PerfJob> &jobs) {
+	ifstream ifs(path.c_str());
+	if (!ifs.is_open()) {
+		return false;
+	}
+
+	deadline = 0;
+	partial = false;
+	jobs.clear();
+	string line;
+	while (getline(ifs, line)) {
+		if (line.empty()) continue;
+		istringstream line_stream(line);
+		if (line[0] == '#') {
+			string comment, key;
+			if (line_stream >> comment >> key && key == "deadline_ns") {
+				line_stream >> deadline;
+			} else if (key == "partial:") {
+				partial = true;
+			}
+			continue;
+		}
+
+		unsigned job;
+		PerfJob perf_job;
+		line_stream >> job >> perf_job.response_time;
+		for (unsigned c=0; c<kPerfCounters; c++) {
+			line_stream >> perf_job.values[c];
+		}
+		if (line_stream.fail()) {
+			return false;
+		}
+		jobs.push_back(perf_job);
+	}
+	return true;
+}
@@ -0,0 +1,91 @@
+// Per-job hardware and scheduler counters of a task (perf_event_open).
+//
+// Each thread of the task's OpenMP team opens a group of counters that count
+// its own execution, on whatever CPU it runs: cycles, instructions, last-level
+// cache misses, context switches and CPU migrations. The groups are opened
+// from inside a parallel region once the team exists, since the threads of
+// the team persist across the task's parallel regions. The task manager reads
+// all the groups from the master thread before and after each job, and keeps
+// the difference of their sums. Counters that the machine or the kernel does
+// not provide (e.g., hardware counters in a virtual machine) are left out of
+// the groups and reported as unavailable.
+//
+// Reading a group of a thread that is running (e.g., an OpenMP thread spinning
+// after a parallel region) interrupts its CPU, so the counters add a small
+// overhead at each job boundary. The workers of worker_pool.h are not OpenMP
+// threads: when the strands run on the pool (RT_GOMP_WORKER_POOL=1, or a task
+// reclaiming lent cores), only the master thread is counted. The task manager
+// then marks the counters as partial.
+//
+// Counter file format (.perf, text): comment lines start with #, the first of
+// which gives the task's relative deadline, then one line per job:
+//   <job> <response ns> <cycles> <instructions> <llc misses> <context switches> <cpu migrations>
+// where unavailable counters are -1. Partial counters have a comment line
+//   # partial: <reason>
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+enum Perf_Counter {
+	PERF_CYCLES = 0,
+	PERF_INSTRUCTIONS = 1,
+	PERF_LLC_MISSES = 2,
+	PERF_CONTEXT_SWITCHES = 3,
+	PERF_CPU_MIGRATIONS = 4
+};
+const unsigned kPerfCounters = 5;
+
+// Names of the counters, as in the header of the .perf files
+extern const char *const kPerfCounterNames[kPerfCounters];
+
+// Group of counters of a thread. Aligned to a cache line since each thread
+// writes its own when opening it.
+typedef struct ThreadPerfGroup {
+	int leader_fd; // -1 if no counter could be opened
+	int fds[kPerfCounters];
+	int position[kPerfCounters]; // index of the counter in a group read, -1 if not opened
+} __attribute__((aligned(64))) ThreadPerfGroup;
+
+typedef struct PerfCounters {
+	unsigned num_threads;
+	ThreadPerfGroup *groups;
+	bool partial; // whether threads that run the task's jobs are not counted
+} PerfCounters;
+
+// Allocate (closed) groups for @num_threads threads, not partial. Return false
+// on failure.
+bool init_perf_counters(PerfCounters &counters, unsigned num_threads);
+
+// Open the group of thread @thread, counting the calling thread. Must be
+// called by each thread of the team. Return false if no counter could be opened.
+bool open_thread_perf_counters(PerfCounters &counters, unsigned thread);
+
+// Whether counter @counter is counted on every thread
+bool perf_counter_available(const PerfCounters &counters, unsigned counter);
+
+// Read the sums over all threads of each counter (0 for unavailable ones)
+void read_perf_counters(const PerfCounters &counters, uint64_t values[kPerfCounters]);
+
+// Write the counters of @num_jobs jobs (num_jobs x kPerfCounters deltas, job
+// after job) and their response times to a .perf file. Return false on failure.
+bool write_perf_counters(const char *path, const PerfCounters &counters, uint64_t deadline,
+						 unsigned num_jobs, const uint64_t *response_times, const uint64_t *values);
+
+// Close the groups and free them
+void free_perf_counters(PerfCounters &counters);
+
+// A job of a .perf file
+typedef struct PerfJob {
+	uint64_t response_time;
+	int64_t values[kPerfCounters]; // -1 if unavailable
+} PerfJob;
+
+// Read a .perf file, and whether its counters are partial. Return false if it
+// cannot be opened or parsed.
+bool read_perf_file(const std::string &path, uint64_t &deadline, bool &partial, std::vector<PerfJob> &jobs);
+
+#endif // PERF_COUNTERS_H
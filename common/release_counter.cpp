@@ -0,0 +1,111 @@
+// Counter of the task threads ready for release. See release_counter.h.
+
+#include <fcntl.h>
+#include <time.h>
+#include <climits>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <new>
+#include "release_counter.h"
+
+using namespace std;
+
+static_assert(sizeof(atomic<uint32_t>) == sizeof(uint32_t), "futex words must be 32 bits");
+
+// The counter is shared between processes, so the futex calls are not private
+static void futex_wait(atomic<uint32_t> &word, uint32_t expected, const timespec *timeout) {
+	syscall(SYS_futex, (uint32_t*)&word, FUTEX_WAIT, expected, timeout, NULL, 0);
+}
+
+static void futex_wake_all(atomic<uint32_t> &word) {
+	syscall(SYS_futex, (uint32_t*)&word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+static ReleaseCounter *map_counter(int fd) {
+	void *addr = mmap(NULL, sizeof(ReleaseCounter), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	return (addr == MAP_FAILED) ? NULL : (ReleaseCounter*) addr;
+}
+
+ReleaseCounter *create_release_counter(const char *name) {
+	int fd = shm_open(name, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+	if (fd == -1) {
+		return NULL;
+	}
+	if (ftruncate(fd, sizeof(ReleaseCounter)) != 0) {
+		close(fd);
+		shm_unlink(name);
+		return NULL;
+	}
+
+	ReleaseCounter *counter = map_counter(fd);
+	if (counter != NULL) {
+		new (&counter->ready) atomic<uint32_t>(0);
+		new (&counter->released) atomic<uint32_t>(0);
+		counter->release_time = 0;
+	}
+	return counter;
+}
+
+ReleaseCounter *open_release_counter(const char *name) {
+	int fd = shm_open(name, O_RDWR, 0);
+	if (fd == -1) {
+		return NULL;
+	}
+	return map_counter(fd);
+}
+
+void release_counter_arrive(ReleaseCounter *counter) {
+	counter->ready.fetch_add(1);
+	futex_wake_all(counter->ready);
+}
+
+uint32_t release_counter_wait(ReleaseCounter *counter, uint32_t expected, unsigned timeout_ms) {
+	timespec now, end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	end.tv_sec += timeout_ms / 1000;
+	end.tv_nsec += (timeout_ms % 1000) * 1000000L;
+	if (end.tv_nsec >= 1000000000L) {
+		end.tv_sec++;
+		end.tv_nsec -= 1000000000L;
+	}
+
+	uint32_t current;
+	while ((current = counter->ready.load()) < expected) {
+		// FUTEX_WAIT takes a relative timeout
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		timespec left = {end.tv_sec - now.tv_sec, end.tv_nsec - now.tv_nsec};
+		if (left.tv_nsec < 0) {
+			left.tv_sec--;
+			left.tv_nsec += 1000000000L;
+		}
+		if (left.tv_sec < 0) {
+			break;
+		}
+		futex_wait(counter->ready, current, &left);
+	}
+	return current;
+}
+
+void release_counter_release(ReleaseCounter *counter, uint64_t release_time) {
+	counter->release_time = release_time;
+	counter->released.store(1);
+	futex_wake_all(counter->released);
+}
+
+uint64_t release_counter_wait_release(ReleaseCounter *counter) {
+	while (counter->released.load() == 0) {
+		futex_wait(counter->released, 0, NULL);
+	}
+	return counter->release_time;
+}
+
+void close_release_counter(ReleaseCounter *counter, const char *name) {
+	munmap(counter, sizeof(ReleaseCounter));
+	if (name != NULL) {
+		shm_unlink(name);
+	}
+}
@@ -0,0 +1,49 @@
+// Counter of the task threads ready for the synchronous release of a task
+// set, shared by the launcher and the task processes.
+//
+// The launcher creates the counter and passes its name to the tasks in
+// RT_GOMP_RELEASE_COUNTER. Each task thread increments it right before it
+// waits for the release, and the launcher sleeps on the counter with a futex
+// until it reaches the expected number of threads, instead of polling.
+//
+// Without Litmus^RT, the counter also carries the release itself: the
+// launcher publishes the release time (CLOCK_MONOTONIC) and wakes up the
+// task threads waiting for it.
+
+#ifndef RELEASE_COUNTER_H
+#define RELEASE_COUNTER_H
+
+#include <stdint.h>
+#include <atomic>
+
+typedef struct ReleaseCounter {
+	std::atomic<uint32_t> ready;
+	std::atomic<uint32_t> released; // set to 1 once release_time is published
+	uint64_t release_time; // in nanoseconds
+} ReleaseCounter;
+
+// Create the shared counter @name (a POSIX shared memory name, e.g.
+// "/RT_GOMP_RELEASE_COUNTER") with a count of zero. NULL on failure.
+ReleaseCounter *create_release_counter(const char *name);
+
+// Open the shared counter @name created by the launcher. NULL on failure.
+ReleaseCounter *open_release_counter(const char *name);
+
+// Count the calling thread as ready and wake up the waiter
+void release_counter_arrive(ReleaseCounter *counter);
+
+// Sleep until the count reaches @expected or @timeout_ms milliseconds have
+// passed. Return the last count seen.
+uint32_t release_counter_wait(ReleaseCounter *counter, uint32_t expected, unsigned timeout_ms);
+
+// Publish the release time @release_time (ns, CLOCK_MONOTONIC) and wake up
+// the threads waiting for it
+void release_counter_release(ReleaseCounter *counter, uint64_t release_time);
+
+// Sleep until the launcher publishes the release time, and return it
+uint64_t release_counter_wait_release(ReleaseCounter *counter);
+
+// Unmap the counter; the creator also removes @name, if not NULL
+void close_release_counter(ReleaseCounter *counter, const char *name);
+
+#endif // RELEASE_COUNTER_H
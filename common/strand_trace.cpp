@@ -0,0 +1,83 @@
+// Per-strand execution tracing for synthetic tasks. See strand_trace.h.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "strand_trace.h"
+
+using namespace std;
+
+bool init_strand_trace(StrandTrace &trace, unsigned num_threads, unsigned capacity) {
+	trace.enabled = false;
+	trace.num_threads = 0;
+	trace.job = 0;
+	trace.rings = NULL;
+
+	// Round the capacity up to a power of two so that the ring index is a mask
+	trace.capacity = 1;
+	while (trace.capacity < capacity) {
+		trace.capacity <<= 1;
+	}
+
+	void *rings;
+	if (num_threads == 0 || posix_memalign(&rings, 64, num_threads * sizeof(StrandTraceRing)) != 0) {
+		return false;
+	}
+	trace.rings = (StrandTraceRing*) rings;
+	trace.num_threads = num_threads;
+
+	for (unsigned i=0; i<num_threads; i++) {
+		size_t size = (size_t)trace.capacity * sizeof(StrandEvent);
+		void *events;
+		if (posix_memalign(&events, 64, size) != 0) {
+			trace.num_threads = i;
+			free_strand_trace(trace);
+			return false;
+		}
+		// Touch the pages now rather than on the first events of the jobs
+		memset(events, 0, size);
+		trace.rings[i].events = (StrandEvent*) events;
+		trace.rings[i].head = 0;
+	}
+
+	trace.enabled = true;
+	return true;
+}
+
+bool write_strand_trace(const string &path, const StrandTrace &trace) {
+	FILE *fp = fopen(path.c_str(), "w");
+	if (fp == NULL) {
+		return false;
+	}
+
+	fprintf(fp, "# job segment strand thread start_cpu end_cpu start_ns end_ns\n");
+	for (unsigned t=0; t<trace.num_threads; t++) {
+		const StrandTraceRing &ring = trace.rings[t];
+		uint64_t first = 0;
+		if (ring.head > trace.capacity) {
+			first = ring.head - trace.capacity;
+			fprintf(fp, "# thread %u: %" PRIu64 " oldest events overwritten\n", t, first);
+		}
+
+		for (uint64_t i=first; i<ring.head; i++) {
+			const StrandEvent &event = ring.events[i & (trace.capacity - 1)];
+			fprintf(fp, "%u %u %ld %u %d %d %" PRIu64 " %" PRIu64 "\n", event.job, event.segment,
+					(event.strand == kSegmentEvent) ? -1L : (long)event.strand, event.thread,
+					event.start_cpu, event.end_cpu, event.start, event.end);
+		}
+	}
+	return (fclose(fp) == 0);
+}
+
+void free_strand_trace(StrandTrace &trace) {
+	if (trace.rings != NULL) {
+		for (unsigned i=0; i<trace.num_threads; i++) {
+			free(trace.rings[i].events);
+		}
+		free(trace.rings);
+		trace.rings = NULL;
+	}
+	trace.num_threads = 0;
+	trace.enabled = false;
+}
@@ -0,0 +1,96 @@
+// Per-strand execution tracing for synthetic tasks.
+//
+// Each OpenMP thread of the task owns a ring buffer of events, allocated and
+// touched before the first job, so recording an event neither allocates nor
+// takes a lock: a thread only writes to its own ring, and the rings are read
+// after the jobs have finished. When a ring is full, the oldest events are
+// overwritten. An event records the start and end times (CLOCK_MONOTONIC, ns)
+// of a strand, and the CPUs it started and ended on (a difference means the
+// strand migrated). The master thread also records one event per segment,
+// from before the fork to after the join, with strand kSegmentEvent.
+//
+// Trace file format (.trace, text): comment lines start with #, then one line
+// per event, ordered by thread and then time:
+//   <job> <segment> <strand> <thread> <start cpu> <end cpu> <start ns> <end ns>
+// where the strand is -1 for the events of whole segments.
+
+#ifndef STRAND_TRACE_H
+#define STRAND_TRACE_H
+
+#include <sched.h>
+#include <stdint.h>
+#include <time.h>
+#include <string>
+
+// Strand number of the events that span a whole segment
+const uint32_t kSegmentEvent = UINT32_MAX;
+
+// Default number of events per thread, must be a power of two
+const unsigned kDefaultTraceEvents = 1 << 16;
+
+typedef struct StrandEvent {
+	uint64_t start;
+	uint64_t end;
+	uint32_t job;
+	uint32_t strand;
+	uint16_t segment;
+	uint16_t thread;
+	int16_t start_cpu;
+	int16_t end_cpu;
+} StrandEvent;
+
+// Aligned to a cache line so that threads do not share the head counters
+typedef struct StrandTraceRing {
+	StrandEvent *events;
+	uint64_t head; // number of events started so far
+} __attribute__((aligned(64))) StrandTraceRing;
+
+typedef struct StrandTrace {
+	bool enabled;
+	unsigned num_threads;
+	unsigned capacity; // events per thread, a power of two
+	uint32_t job; // index of the current job
+	StrandTraceRing *rings;
+} StrandTrace;
+
+// Allocate the rings for @num_threads threads with (at least) @capacity
+// events each. The trace stays disabled if the allocation fails.
+// Return false on failure.
+bool init_strand_trace(StrandTrace &trace, unsigned num_threads, unsigned capacity = kDefaultTraceEvents);
+
+// Write the recorded events to a .trace file. Return false on failure.
+bool write_strand_trace(const std::string &path, const StrandTrace &trace);
+
+// Free the rings and disable the trace
+void free_strand_trace(StrandTrace &trace);
+
+static inline uint64_t strand_trace_now() {
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec*1000000000 + ts.tv_nsec;
+}
+
+// Start an event of thread @thread, which must be below the number of
+// threads of the trace. Return the event to pass to strand_trace_end.
+static inline StrandEvent *strand_trace_begin(StrandTrace &trace, unsigned thread,
+											  unsigned segment, uint32_t strand) {
+	StrandTraceRing &ring = trace.rings[thread];
+	StrandEvent *event = &ring.events[ring.head & (trace.capacity - 1)];
+	ring.head++;
+	event->job = trace.job;
+	event->segment = segment;
+	event->strand = strand;
+	event->thread = thread;
+	event->start_cpu = sched_getcpu();
+	event->start = strand_trace_now();
+	return event;
+}
+
+// Finish an event started by the same thread. Events of a thread may nest,
+// e.g., the strands run by the master thread inside its segment event.
+static inline void strand_trace_end(StrandEvent *event) {
+	event->end = strand_trace_now();
+	event->end_cpu = sched_getcpu();
+}
+
+#endif // STRAND_TRACE_H
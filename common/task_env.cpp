@@ -0,0 +1,60 @@
+// Options of a task process. See task_env.h.
+
+#include <stdlib.h>
+#include <string.h>
+#include <sstream>
+#include "task_env.h"
+
+using namespace std;
+
+static __thread const TaskEnv *thread_task_env = NULL;
+
+static bool env_equals(const char *name, const char *value) {
+	const char *current = getenv(name);
+	return (current != NULL && strcmp(current, value) == 0);
+}
+
+void task_output_env(const string &out_folder, unsigned task_id, const char *suffix, TaskEnv &env) {
+	ostringstream id;
+	id << task_id;
+	env["RT_GOMP_TASK_ID"] = id.str();
+
+	string base = out_folder + "/task" + id.str() + suffix;
+	if (env_equals("RT_GOMP_JOB_RECORDS", "binary")) {
+		env["RT_GOMP_JOB_RECORD_FILE"] = base + ".jobs";
+	} else if (env_equals("RT_GOMP_JOB_RECORDS", "histogram")) {
+		env["RT_GOMP_JOB_HISTOGRAM_FILE"] = base + ".hist";
+	}
+	if (env_equals("RT_GOMP_STRAND_TRACE", "1")) {
+		env["RT_GOMP_STRAND_TRACE_FILE"] = base + ".trace";
+	}
+	if (env_equals("RT_GOMP_WORK_REPORT", "1")) {
+		env["RT_GOMP_WORK_REPORT_FILE"] = base + ".work";
+	}
+	if (env_equals("RT_GOMP_PERF_COUNTERS", "1")) {
+		env["RT_GOMP_PERF_COUNTERS_FILE"] = base + ".perf";
+	}
+	if (env_equals("RT_GOMP_JOB_SUMMARY", "1")) {
+		env["RT_GOMP_JOB_SUMMARY_FILE"] = base + ".summary";
+	}
+}
+
+void export_task_env(const TaskEnv &env) {
+	for (TaskEnv::const_iterator it = env.begin(); it != env.end(); it++) {
+		setenv(it->first.c_str(), it->second.c_str(), 1);
+	}
+}
+
+void set_thread_task_env(const TaskEnv *env) {
+	thread_task_env = env;
+}
+
+const char *task_getenv(const char *name) {
+	if (thread_task_env != NULL) {
+		TaskEnv::const_iterator it = thread_task_env->find(name);
+		if (it != thread_task_env->end()) {
+			return it->second.c_str();
+		}
+	}
+	return getenv(name);
+}
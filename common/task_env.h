@@ -0,0 +1,43 @@
+// Options of a task process, passed as RT_GOMP_* environment variables.
+//
+// The launchers derive per-task variables (e.g., the files the task writes
+// next to its output file) from the experiment-wide ones. Tasks hosted as
+// threads of a single process (fs/task_host.cpp) cannot each have their own
+// environment, so they read their options through task_getenv, which looks
+// first at variables set for the calling thread.
+
+#ifndef TASK_ENV_H
+#define TASK_ENV_H
+
+#include <map>
+#include <string>
+
+typedef std::map<std::string, std::string> TaskEnv;
+
+// Fill @env with the per-task variables of task @task_id, whose output
+// files are <out_folder>/task<task_id><suffix>.<ext>, according to the
+// experiment-wide variables of the process:
+//   RT_GOMP_TASK_ID             always
+//   RT_GOMP_JOB_RECORD_FILE     .jobs, if RT_GOMP_JOB_RECORDS=binary
+//   RT_GOMP_JOB_HISTOGRAM_FILE  .hist, if RT_GOMP_JOB_RECORDS=histogram
+//   RT_GOMP_STRAND_TRACE_FILE   .trace, if RT_GOMP_STRAND_TRACE=1
+//   RT_GOMP_WORK_REPORT_FILE    .work, if RT_GOMP_WORK_REPORT=1
+//   RT_GOMP_PERF_COUNTERS_FILE  .perf, if RT_GOMP_PERF_COUNTERS=1
+//   RT_GOMP_JOB_SUMMARY_FILE    .summary, if RT_GOMP_JOB_SUMMARY=1
+// The FS launchers also set RT_GOMP_EDF_POOL for the tasks of the EDF pool
+// of a hybrid partition (see edf_pool.h), and RT_GOMP_LENDING_BOARD for the
+// other tasks if RT_GOMP_RECLAIM=1 (see core_lending.h).
+void task_output_env(const std::string &out_folder, unsigned task_id, const char *suffix, TaskEnv &env);
+
+// Set the variables of @env in the environment of the process
+void export_task_env(const TaskEnv &env);
+
+// Make task_getenv look up @env first for the calling thread (NULL to clear).
+// @env must outlive its use by the thread.
+void set_thread_task_env(const TaskEnv *env);
+
+// Value of a task option: from the variables set for the calling thread if
+// it has the variable, otherwise from the environment. NULL if unset.
+const char *task_getenv(const char *name);
+
+#endif // TASK_ENV_H
@@ -0,0 +1,292 @@
+// Reading and writing of the task set files used by the experiments.
+// See taskset_io.h for the file formats.
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cerrno>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "taskset_io.h"
+
+using namespace std;
+
+bool parse_command_line(const string &line, string &program_name, vector<SegmentSpec> &segments) {
+	istringstream command_stream(line);
+	unsigned num_segments;
+	if (!(command_stream >> program_name && command_stream >> num_segments)) {
+		return false;
+	}
+
+	segments.clear();
+	for (unsigned i=0; i<num_segments; i++) {
+		unsigned num_strands;
+		unsigned long len_sec, len_ns;
+		if (!(command_stream >> num_strands &&
+			  command_stream >> len_sec &&
+			  command_stream >> len_ns)) {
+			return false;
+		}
+
+		SegmentSpec segment;
+		segment.num_strands = num_strands;
+		segment.len = to_nsec(len_sec, len_ns);
+
+		// An optional workload follows the length, and starts with a letter
+		command_stream >> ws;
+		if (isalpha(command_stream.peek())) {
+			command_stream >> segment.workload;
+		}
+		segments.push_back(segment);
+	}
+
+	return true;
+}
+
+bool parse_cpu_list(const string &list, vector<unsigned> &cpus) {
+	cpus.clear();
+	istringstream list_stream(list);
+	string range;
+	while (getline(list_stream, range, ',')) {
+		unsigned first, last;
+		char dash;
+		istringstream range_stream(range);
+		if (!(range_stream >> first)) return false;
+		last = first;
+		if (range_stream >> dash && !(dash == '-' && range_stream >> last)) return false;
+		if (last < first) return false;
+		for (unsigned cpu=first; cpu<=last; cpu++) {
+			cpus.push_back(cpu);
+		}
+	}
+	return !cpus.empty();
+}
+
+string format_cpu_list(vector<unsigned> cpus) {
+	sort(cpus.begin(), cpus.end());
+	ostringstream list;
+	for (unsigned i=0; i<cpus.size(); ) {
+		unsigned j = i;
+		while (j+1 < cpus.size() && cpus[j+1] == cpus[j] + 1) j++;
+		if (i != 0) list << ",";
+		list << cpus[i];
+		if (j != i) list << "-" << cpus[j];
+		i = j+1;
+	}
+	return list.str();
+}
+
+bool parse_timing_line(const string &line, TaskSpec &task) {
+	istringstream timing_stream(line);
+	unsigned long work_sec, span_sec, period_sec, deadline_sec, release_sec;
+	unsigned long work_ns, span_ns, period_ns, deadline_ns, release_ns;
+	unsigned num_iters;
+	if ( !(timing_stream >> work_sec &&
+		   timing_stream >> work_ns &&
+		   timing_stream >> span_sec &&
+		   timing_stream >> span_ns &&
+		   timing_stream >> period_sec &&
+		   timing_stream >> period_ns &&
+		   timing_stream >> deadline_sec &&
+		   timing_stream >> deadline_ns &&
+		   timing_stream >> release_sec &&
+		   timing_stream >> release_ns &&
+		   timing_stream >> num_iters) ) {
+		return false;
+	}
+
+	task.work = to_nsec(work_sec, work_ns);
+	task.span = to_nsec(span_sec, span_ns);
+	task.period = to_nsec(period_sec, period_ns);
+	task.deadline = to_nsec(deadline_sec, deadline_ns);
+	task.release = to_nsec(release_sec, release_ns);
+	task.num_iters = num_iters;
+	return true;
+}
+
+// Read the lines of a task set file in a single pass
+static bool read_lines(const string &path, vector<string> &lines) {
+	ifstream ifs(path.c_str());
+	if (!ifs.is_open()) {
+		cerr << "ERROR: Cannot open file " << path << endl;
+		return false;
+	}
+
+	string line;
+	while (getline(ifs, line)) {
+		lines.push_back(line);
+	}
+	return true;
+}
+
+// Parse the task set from its lines. @with_partition is true for .rtps files.
+static bool parse_taskset(const string &path, const vector<string> &lines,
+						  bool with_partition, TaskSetSpec &ts) {
+	unsigned header_lines = with_partition ? 2 : 1;
+	unsigned lines_per_task = with_partition ? 3 : 2;
+	if ( !(lines.size() > header_lines && (lines.size() - header_lines) % lines_per_task == 0) ) {
+		cerr << "ERROR: Incorrect number of lines in " << path << endl;
+		return false;
+	}
+
+	ts.status = -1;
+	if (with_partition) {
+		istringstream status_stream(lines[0]);
+		if (!(status_stream >> ts.status)) {
+			cerr << "ERROR: Cannot read partition status in " << path << endl;
+			return false;
+		}
+	}
+
+	ts.core_range_line = lines[header_lines-1];
+	istringstream core_range_stream(ts.core_range_line);
+	if ( !(core_range_stream >> ts.sys_first_core &&
+		   core_range_stream >> ts.sys_last_core) ||
+		 ts.sys_last_core < ts.sys_first_core ) {
+		cerr << "ERROR: Cannot read system core range in " << path << endl;
+		return false;
+	}
+
+	unsigned num_tasks = (lines.size() - header_lines) / lines_per_task;
+	ts.tasks.clear();
+	ts.tasks.reserve(num_tasks);
+	for (unsigned i=0; i<num_tasks; i++) {
+		unsigned base = header_lines + i*lines_per_task;
+		TaskSpec task;
+		task.id = i+1;
+		task.command_line = lines[base];
+		task.timing_line = lines[base+1];
+		task.first_core = -1;
+		task.last_core = -1;
+		task.priority = -1;
+		task.edf_pool = false;
+
+		if (!parse_command_line(task.command_line, task.program_name, task.segments)) {
+			cerr << "ERROR: Task " << task.id << " command line improperly provided in " << path << endl;
+			return false;
+		}
+
+		if (!parse_timing_line(task.timing_line, task)) {
+			cerr << "ERROR: Task " << task.id << " timing parameters improperly provided in " << path << endl;
+			return false;
+		}
+
+		if (with_partition) {
+			istringstream partition_stream(lines[base+2]);
+			if ( !(partition_stream >> task.first_core &&
+				   partition_stream >> task.last_core &&
+				   partition_stream >> task.priority) ) {
+				cerr << "ERROR: Task " << task.id << " partition improperly provided in " << path << endl;
+				return false;
+			}
+
+			string cpu_list, marker;
+			if (partition_stream >> cpu_list && cpu_list != "edf") {
+				if (!parse_cpu_list(cpu_list, task.cpus)) {
+					cerr << "ERROR: Task " << task.id << " CPU list improperly provided in " << path << endl;
+					return false;
+				}
+				partition_stream >> marker;
+			} else {
+				marker = cpu_list;
+			}
+			task.edf_pool = (marker == "edf");
+			if (!(marker.empty() || task.edf_pool)) {
+				cerr << "ERROR: Task " << task.id << " partition improperly provided in " << path << endl;
+				return false;
+			}
+
+			if (task.cpus.empty()) {
+				for (int cpu=task.first_core; cpu>=0 && cpu<=task.last_core; cpu++) {
+					task.cpus.push_back(cpu);
+				}
+			}
+		}
+
+		ts.tasks.push_back(task);
+	}
+
+	return true;
+}
+
+bool read_rtpt(const string &path, TaskSetSpec &ts) {
+	vector<string> lines;
+	if (!read_lines(path, lines)) {
+		return false;
+	}
+	return parse_taskset(path, lines, false, ts);
+}
+
+bool read_rtps(const string &path, TaskSetSpec &ts) {
+	vector<string> lines;
+	if (!read_lines(path, lines)) {
+		return false;
+	}
+	return parse_taskset(path, lines, true, ts);
+}
+
+// Compare two file names so that embedded numbers are ordered by value,
+// e.g., taskset2.rtpt comes before taskset10.rtpt.
+static bool natural_less(const string &a, const string &b) {
+	size_t i = 0, j = 0;
+	while (i < a.size() && j < b.size()) {
+		if (isdigit(a[i]) && isdigit(b[j])) {
+			size_t i_end = i, j_end = j;
+			while (i_end < a.size() && isdigit(a[i_end])) i_end++;
+			while (j_end < b.size() && isdigit(b[j_end])) j_end++;
+			unsigned long a_num = strtoul(a.substr(i, i_end-i).c_str(), NULL, 10);
+			unsigned long b_num = strtoul(b.substr(j, j_end-j).c_str(), NULL, 10);
+			if (a_num != b_num) return a_num < b_num;
+			i = i_end;
+			j = j_end;
+		} else {
+			if (a[i] != b[j]) return a[i] < b[j];
+			i++;
+			j++;
+		}
+	}
+	return (a.size() - i) < (b.size() - j);
+}
+
+vector<string> list_files(const string &dir, const string &ext) {
+	vector<string> names;
+	DIR *dp = opendir(dir.c_str());
+	if (dp == NULL) {
+		cerr << "ERROR: Cannot open directory " << dir << endl;
+		return names;
+	}
+
+	struct dirent *entry;
+	while ((entry = readdir(dp)) != NULL) {
+		string name(entry->d_name);
+		if (name.size() > ext.size() &&
+			name.compare(name.size() - ext.size(), ext.size(), ext) == 0) {
+			names.push_back(name);
+		}
+	}
+	closedir(dp);
+
+	sort(names.begin(), names.end(), natural_less);
+
+	vector<string> paths;
+	for (unsigned i=0; i<names.size(); i++) {
+		paths.push_back(dir + "/" + names[i]);
+	}
+	return paths;
+}
+
+bool is_directory(const string &path) {
+	struct stat st;
+	return (stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode));
+}
+
+bool make_dir(const string &path) {
+	if (mkdir(path.c_str(), S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) != 0 && errno != EEXIST) {
+		cerr << "ERROR: Cannot create directory " << path << endl;
+		return false;
+	}
+	return true;
+}
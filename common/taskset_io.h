@@ -0,0 +1,97 @@
+// Reading and writing of the task set files used by the experiments.
+//
+// A .rtpt file starts with a line containing the system first and last cores,
+// followed by two lines for each task:
+//   - the task's command line: program-name num-segments {[num-strands len-sec len-ns [workload]] ...}
+//     (the optional workload of a segment is described in workload.h)
+//   - the task's timing parameters: work, span, period, deadline, release
+//     (each as a pair <sec, nsec>) and the number of iterations.
+// A .rtps file has one more line at the beginning (the FS partition status)
+// and one more line for each task (its first core, last core and priority,
+// optionally followed by the explicit list of its CPUs, e.g., 0-3,8-11, in
+// which case the first and last cores are the lowest and highest of them,
+// and by "edf" for the tasks that share the EDF pool of a hybrid partition
+// instead of having dedicated cores; the pool's CPUs are their CPUs).
+
+#ifndef TASKSET_IO_H
+#define TASKSET_IO_H
+
+#include <string>
+#include <vector>
+
+const unsigned long kNsecPerSec = 1000000000;
+
+// A segment of a synthetic task: a number of strands of the same length
+typedef struct SegmentSpec {
+	unsigned num_strands;
+	unsigned long len; // in nanoseconds
+	std::string workload; // empty if the segment runs the task's work kernel
+} SegmentSpec;
+
+// A task as written in the task set files.
+// All timing information is in nanoseconds.
+typedef struct TaskSpec {
+	unsigned id; // 1-based id of the task, in file order
+	std::string command_line; // the raw command line of the task
+	std::string timing_line; // the raw timing parameters line of the task
+	std::string program_name;
+	std::vector<SegmentSpec> segments;
+	unsigned long work;
+	unsigned long span;
+	unsigned long period;
+	unsigned long deadline;
+	unsigned long release;
+	unsigned num_iters;
+	int first_core; // partition of the task, -1 if not read from a .rtps file
+	int last_core;
+	int priority;
+	std::vector<unsigned> cpus; // CPUs of the partition: its CPU list, or first_core .. last_core
+	bool edf_pool; // shares the EDF pool of a hybrid partition
+} TaskSpec;
+
+// A task set read from a .rtpt or .rtps file
+typedef struct TaskSetSpec {
+	int status; // FS partition status from a .rtps file, -1 for a .rtpt file
+	unsigned sys_first_core;
+	unsigned sys_last_core;
+	std::string core_range_line; // the raw system core range line
+	std::vector<TaskSpec> tasks;
+} TaskSetSpec;
+
+// Convert a pair of <seconds, nanoseconds> to nanoseconds
+inline unsigned long to_nsec(unsigned long sec, unsigned long nsec) {
+	return sec * kNsecPerSec + nsec;
+}
+
+// Parse the command line of a synthetic task into its segments.
+// Return false if the line is malformed.
+bool parse_command_line(const std::string &line, std::string &program_name,
+						std::vector<SegmentSpec> &segments);
+
+// Parse a CPU list such as 0-3,8,10-11. Return false if it is malformed.
+bool parse_cpu_list(const std::string &list, std::vector<unsigned> &cpus);
+
+// Format CPUs as a CPU list, with ranges for consecutive CPUs
+std::string format_cpu_list(std::vector<unsigned> cpus);
+
+// Parse a timing parameters line into the task's timing fields.
+// Return false if the line is malformed.
+bool parse_timing_line(const std::string &line, TaskSpec &task);
+
+// Read a .rtpt file. Errors are reported to stderr and false is returned.
+bool read_rtpt(const std::string &path, TaskSetSpec &ts);
+
+// Read a .rtps file. Errors are reported to stderr and false is returned.
+bool read_rtps(const std::string &path, TaskSetSpec &ts);
+
+// Return the paths of the files in a directory that end with the extension
+// (for example ".rtpt"), sorted by the task set number in their names.
+std::vector<std::string> list_files(const std::string &dir, const std::string &ext);
+
+// Return true if the path is an existing directory
+bool is_directory(const std::string &path);
+
+// Create a directory if it does not exist yet. Return false on failure.
+bool make_dir(const std::string &path);
+
+#endif // TASKSET_IO_H
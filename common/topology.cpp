@@ -0,0 +1,169 @@
+// CPU topology of the machine. See topology.h.
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <map>
+#include <cctype>
+#include <cstdlib>
+#include <dirent.h>
+#include "topology.h"
+#include "taskset_io.h"
+
+using namespace std;
+
+// Read the first line of a sysfs file
+static bool read_sysfs_line(const string &path, string &line) {
+	ifstream ifs(path.c_str());
+	return ifs.is_open() && getline(ifs, line);
+}
+
+// Lowest CPU of a CPU list file, e.g., the siblings of a CPU
+static bool read_lowest_cpu(const string &path, unsigned &cpu) {
+	string line;
+	vector<unsigned> cpus;
+	if (!read_sysfs_line(path, line) || !parse_cpu_list(line, cpus) || cpus.empty()) {
+		return false;
+	}
+	cpu = *min_element(cpus.begin(), cpus.end());
+	return true;
+}
+
+// The LLC of a CPU is its unified or data cache of the highest level
+static unsigned read_llc(const string &cpu_dir, unsigned cpu) {
+	unsigned llc = cpu, llc_level = 0;
+	for (unsigned index=0; ; index++) {
+		ostringstream cache_dir;
+		cache_dir << cpu_dir << "/cache/index" << index;
+		string level_line, type;
+		if (!read_sysfs_line(cache_dir.str() + "/level", level_line)) break;
+		if (read_sysfs_line(cache_dir.str() + "/type", type) && type == "Instruction") continue;
+
+		unsigned level = atoi(level_line.c_str()), shared;
+		if (level > llc_level && read_lowest_cpu(cache_dir.str() + "/shared_cpu_list", shared)) {
+			llc_level = level;
+			llc = shared;
+		}
+	}
+	return llc;
+}
+
+// Map the CPUs to their NUMA nodes from the node<N>/cpulist files next to the cpu folder
+static void read_nodes(const string &root, map<unsigned, unsigned> &nodes) {
+	string node_root = root.substr(0, root.rfind('/')) + "/node";
+	DIR *dir = opendir(node_root.c_str());
+	if (dir == NULL) return;
+
+	struct dirent *entry;
+	while ((entry = readdir(dir)) != NULL) {
+		string name(entry->d_name);
+		if (name.compare(0, 4, "node") != 0 || name.size() == 4 || !isdigit(name[4])) continue;
+
+		string line;
+		vector<unsigned> cpus;
+		if (read_sysfs_line(node_root + "/" + name + "/cpulist", line) && parse_cpu_list(line, cpus)) {
+			for (unsigned i=0; i<cpus.size(); i++) {
+				nodes[cpus[i]] = atoi(name.c_str() + 4);
+			}
+		}
+	}
+	closedir(dir);
+}
+
+bool read_sysfs_topology(Topology &topology, const string &root) {
+	topology.cpus.clear();
+
+	string line;
+	vector<unsigned> online;
+	if (!read_sysfs_line(root + "/online", line) || !parse_cpu_list(line, online)) {
+		return false;
+	}
+
+	map<unsigned, unsigned> nodes;
+	read_nodes(root, nodes);
+
+	for (unsigned i=0; i<online.size(); i++) {
+		ostringstream cpu_dir;
+		cpu_dir << root << "/cpu" << online[i];
+
+		CpuTopology cpu;
+		cpu.cpu = online[i];
+		if (!read_lowest_cpu(cpu_dir.str() + "/topology/thread_siblings_list", cpu.core)) {
+			cpu.core = cpu.cpu;
+		}
+		cpu.llc = read_llc(cpu_dir.str(), cpu.cpu);
+		cpu.node = (nodes.count(cpu.cpu) != 0) ? nodes[cpu.cpu] : 0;
+		topology.cpus.push_back(cpu);
+	}
+	return !topology.cpus.empty();
+}
+
+bool read_topology_file(const string &path, Topology &topology) {
+	ifstream ifs(path.c_str());
+	if (!ifs.is_open()) {
+		cerr << "ERROR: Cannot open topology file " << path << endl;
+		return false;
+	}
+
+	topology.cpus.clear();
+	string line;
+	while (getline(ifs, line)) {
+		if (line.empty() || line[0] == '#') continue;
+		istringstream line_stream(line);
+		CpuTopology cpu;
+		if (!(line_stream >> cpu.cpu >> cpu.core >> cpu.llc >> cpu.node)) {
+			cerr << "ERROR: Cannot parse line \"" << line << "\" of topology file " << path << endl;
+			return false;
+		}
+		topology.cpus.push_back(cpu);
+	}
+
+	sort(topology.cpus.begin(), topology.cpus.end(),
+		 [](const CpuTopology &a, const CpuTopology &b) { return a.cpu < b.cpu; });
+	for (unsigned i=1; i<topology.cpus.size(); i++) {
+		if (topology.cpus[i].cpu == topology.cpus[i-1].cpu) {
+			cerr << "ERROR: CPU " << topology.cpus[i].cpu << " appears twice in topology file " << path << endl;
+			return false;
+		}
+	}
+	if (topology.cpus.empty()) {
+		cerr << "ERROR: No CPU in topology file " << path << endl;
+		return false;
+	}
+	return true;
+}
+
+bool write_topology_file(const string &path, const Topology &topology) {
+	ofstream ofs(path.c_str());
+	if (!ofs.is_open()) {
+		cerr << "ERROR: Cannot write topology file " << path << endl;
+		return false;
+	}
+
+	ofs << "# cpu core llc node\n";
+	for (unsigned i=0; i<topology.cpus.size(); i++) {
+		const CpuTopology &cpu = topology.cpus[i];
+		ofs << cpu.cpu << " " << cpu.core << " " << cpu.llc << " " << cpu.node << "\n";
+	}
+	ofs.close();
+	return !ofs.fail();
+}
+
+void flat_topology(unsigned first_cpu, unsigned last_cpu, Topology &topology) {
+	topology.cpus.clear();
+	for (unsigned i=first_cpu; i<=last_cpu; i++) {
+		CpuTopology cpu = {i, i, first_cpu, 0};
+		topology.cpus.push_back(cpu);
+	}
+}
+
+bool restrict_topology(const Topology &topology, unsigned first_cpu, unsigned last_cpu, Topology &restricted) {
+	restricted.cpus.clear();
+	for (unsigned i=0; i<topology.cpus.size(); i++) {
+		if (topology.cpus[i].cpu >= first_cpu && topology.cpus[i].cpu <= last_cpu) {
+			restricted.cpus.push_back(topology.cpus[i]);
+		}
+	}
+	return restricted.cpus.size() == last_cpu - first_cpu + 1;
+}
@@ -0,0 +1,48 @@
+// CPU topology of the machine, used to place the FS clusters.
+//
+// Each CPU (hardware thread) belongs to a physical core, a last-level cache
+// (LLC) domain and a NUMA node. The topology is read from sysfs, or from a
+// topology file so that task sets can be partitioned for a machine other
+// than the one running the partitioner, reproducibly.
+//
+// Topology file format (.topo, text): comment lines start with #, then one
+// line per CPU:
+//   <cpu> <core> <llc> <node>
+// where the CPUs of the same physical core (SMT siblings) have the same core,
+// the CPUs sharing the last-level cache have the same llc, and node is the
+// NUMA node. Core and LLC domains are numbered by their lowest CPU.
+
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <string>
+#include <vector>
+
+typedef struct CpuTopology {
+	unsigned cpu;
+	unsigned core;
+	unsigned llc;
+	unsigned node;
+} CpuTopology;
+
+typedef struct Topology {
+	std::vector<CpuTopology> cpus; // by increasing CPU number
+} Topology;
+
+// Read the topology of the online CPUs from sysfs (@root is the folder of
+// the cpu<N> folders). Return false if sysfs cannot be read.
+bool read_sysfs_topology(Topology &topology, const std::string &root = "/sys/devices/system/cpu");
+
+// Read or write a topology file. Errors are reported to stderr and false is returned.
+bool read_topology_file(const std::string &path, Topology &topology);
+bool write_topology_file(const std::string &path, const Topology &topology);
+
+// A topology of the CPUs @first_cpu .. @last_cpu, each a core of its own,
+// sharing a single LLC and node (the placement of the former partitioner)
+void flat_topology(unsigned first_cpu, unsigned last_cpu, Topology &topology);
+
+// Keep the CPUs @first_cpu .. @last_cpu of @topology. Return false if some
+// of them are not in the topology.
+bool restrict_topology(const Topology &topology, unsigned first_cpu, unsigned last_cpu, Topology &restricted);
+
+#endif // TOPOLOGY_H
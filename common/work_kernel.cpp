@@ -0,0 +1,62 @@
+// Work kernels for the strands of synthetic tasks. See work_kernel.h.
+
+#include <string.h>
+#include <time.h>
+#include "work_kernel.h"
+
+// Iterations of one calibration run, and number of runs
+const uint64_t kCalibrationIterations = 1 << 22;
+const unsigned kCalibrationRuns = 10;
+
+// Keeps the result of the work loop alive
+volatile uint64_t work_loop_sink;
+
+bool parse_work_kernel(const char *name, Work_Kernel &kernel) {
+	if (strcmp(name, "wall") == 0) {
+		kernel = WORK_WALL_CLOCK;
+	} else if (strcmp(name, "cputime") == 0) {
+		kernel = WORK_CPU_TIME;
+	} else if (strcmp(name, "loop") == 0) {
+		kernel = WORK_CALIBRATED_LOOP;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+uint64_t thread_cpu_time() {
+	timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (uint64_t)ts.tv_sec*1000000000 + ts.tv_nsec;
+}
+
+void cpu_time_work(uint64_t len) {
+	uint64_t end = thread_cpu_time() + len;
+	while (thread_cpu_time() < end);
+}
+
+// A chain of dependent multiply-adds, so that every iteration takes the same time
+static void work_loop(uint64_t iterations) {
+	uint64_t x = iterations;
+	for (uint64_t i=0; i<iterations; i++) {
+		x = x*6364136223846793005ULL + 1442695040888963407ULL;
+	}
+	work_loop_sink = x;
+}
+
+double calibrate_work_loop() {
+	// The fastest run is the one least disturbed by interrupts and cache misses
+	uint64_t best = UINT64_MAX;
+	for (unsigned i=0; i<kCalibrationRuns; i++) {
+		uint64_t start = thread_cpu_time();
+		work_loop(kCalibrationIterations);
+		uint64_t duration = thread_cpu_time() - start;
+		if (duration < best) best = duration;
+	}
+	if (best == 0) best = 1;
+	return (double)kCalibrationIterations/best;
+}
+
+void calibrated_loop_work(uint64_t len, double iterations_per_ns) {
+	work_loop((uint64_t)(len*iterations_per_ns));
+}
@@ -0,0 +1,40 @@
+// Work kernels for the strands of synthetic tasks.
+//
+// busy_work of timespec_functions spins until a wall-clock length has
+// elapsed, so a strand that is preempted or migrates while spinning does less
+// work than requested. The kernels here consume the requested amount of CPU
+// time of the calling thread instead:
+//   WORK_CPU_TIME          spins until the thread's CPU time has advanced by the length
+//   WORK_CALIBRATED_LOOP   runs a loop for as many iterations as take the length,
+//                          according to a calibration done at startup
+// The calibrated loop does a fixed amount of computation, but its duration
+// depends on the CPU frequency, which should thus be fixed.
+
+#ifndef WORK_KERNEL_H
+#define WORK_KERNEL_H
+
+#include <stdint.h>
+
+enum Work_Kernel {
+	WORK_WALL_CLOCK = 0, // busy_work of timespec_functions
+	WORK_CPU_TIME = 1,
+	WORK_CALIBRATED_LOOP = 2
+};
+
+// Parse a kernel name: wall, cputime or loop. Return false if it is unknown.
+bool parse_work_kernel(const char *name, Work_Kernel &kernel);
+
+// CPU time consumed by the calling thread (ns)
+uint64_t thread_cpu_time();
+
+// Spin until the calling thread has consumed @len ns of CPU time
+void cpu_time_work(uint64_t len);
+
+// Measure how many iterations of the work loop run per ns of CPU time.
+// Takes a few tens of milliseconds.
+double calibrate_work_loop();
+
+// Run the work loop for @len ns, with the rate from calibrate_work_loop
+void calibrated_loop_work(uint64_t len, double iterations_per_ns);
+
+#endif // WORK_KERNEL_H
@@ -0,0 +1,294 @@
+// Pool of persistent worker threads. See worker_pool.h.
+
+#include <sched.h>
+#include <stdio.h>
+#include <time.h>
+#include <climits>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include "worker_pool.h"
+
+using namespace std;
+
+static_assert(sizeof(atomic<uint32_t>) == sizeof(uint32_t), "futex words must be 32 bits");
+
+static void futex_wait(atomic<uint32_t> &word, uint32_t expected) {
+	syscall(SYS_futex, (uint32_t*)&word, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+static void futex_wake_all(atomic<uint32_t> &word) {
+	syscall(SYS_futex, (uint32_t*)&word, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+static inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__)
+	asm volatile("yield");
+#endif
+}
+
+// Wait until @word is no longer @value: poll it @spin times, then sleep on it.
+// @sleeping counts the threads sleeping on the word, so that the thread which
+// changes the word only makes the wake-up system call when needed.
+static uint32_t wait_while_equal(atomic<uint32_t> &word, uint32_t value, atomic<uint32_t> &sleeping, unsigned spin) {
+	uint32_t current;
+	for (unsigned i=0; i<spin; i++) {
+		current = word.load(memory_order_acquire);
+		if (current != value) return current;
+		cpu_relax();
+	}
+
+	while ((current = word.load(memory_order_acquire)) == value) {
+		sleeping.fetch_add(1);
+		futex_wait(word, value);
+		sleeping.fetch_sub(1);
+	}
+	return current;
+}
+
+// Run the strands of the current segment assigned to thread @index
+static void run_strands(WorkerPool &pool, unsigned index) {
+	unsigned num_strands = pool.num_strands;
+	if (pool.dynamic) {
+		unsigned chunk = pool.chunk;
+		for (unsigned first = pool.next_strand.fetch_add(chunk, memory_order_relaxed); first < num_strands;
+			 first = pool.next_strand.fetch_add(chunk, memory_order_relaxed)) {
+			unsigned last = (first + chunk < num_strands) ? first + chunk : num_strands;
+			for (unsigned s=first; s<last; s++) {
+				pool.func(pool.arg, s, index);
+			}
+		}
+	} else {
+		for (unsigned s=index; s<num_strands; s+=pool.num_threads) {
+			pool.func(pool.arg, s, index);
+		}
+	}
+}
+
+static uint64_t monotonic_now() {
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Take chunks of strands of the current segment on a borrowed CPU, as long
+// as the guest can finish them before the CPU must be returned
+static void run_guest_strands(WorkerPool &pool, const PoolWorker &guest) {
+	unsigned num_strands = pool.num_strands;
+	unsigned chunk = pool.chunk;
+	uint64_t chunk_len = pool.strand_len * chunk;
+	while (monotonic_now() + chunk_len <= guest.return_by) {
+		unsigned first = pool.next_strand.fetch_add(chunk, memory_order_relaxed);
+		if (first >= num_strands) break;
+		unsigned last = (first + chunk < num_strands) ? first + chunk : num_strands;
+		for (unsigned s=first; s<last; s++) {
+			pool.func(pool.arg, s, guest.index);
+		}
+	}
+}
+
+// The last thread to finish a segment wakes up the caller if it went to sleep
+static void leave_segment(WorkerPool &pool) {
+	if (pool.remaining.fetch_sub(1) == 1 && pool.caller_sleeping.load() != 0) {
+		futex_wake_all(pool.remaining);
+	}
+}
+
+static void *guest_main(void *arg) {
+	PoolWorker *guest = (PoolWorker*) arg;
+	WorkerPool &pool = *guest->pool;
+
+	uint32_t dispatch = 0;
+	while (true) {
+		dispatch = wait_while_equal(guest->dispatch, dispatch, guest->sleeping, pool.spin);
+		if (pool.stop) break;
+
+		run_guest_strands(pool, *guest);
+		leave_segment(pool);
+	}
+	return NULL;
+}
+
+static void *worker_main(void *arg) {
+	PoolWorker *worker = (PoolWorker*) arg;
+	WorkerPool &pool = *worker->pool;
+
+	uint32_t generation = 0;
+	while (true) {
+		generation = wait_while_equal(pool.generation, generation, pool.sleeping, pool.spin);
+		if (pool.stop) break;
+
+		run_strands(pool, worker->index);
+		leave_segment(pool);
+	}
+	return NULL;
+}
+
+// Pin the calling thread to the index-th CPU of @cpus
+static void pin_thread(pthread_t thread, const cpu_set_t &cpus, unsigned index) {
+	unsigned seen = 0;
+	for (unsigned cpu=0; cpu<CPU_SETSIZE; cpu++) {
+		if (!CPU_ISSET(cpu, &cpus)) continue;
+		if (seen++ == index) {
+			cpu_set_t mask;
+			CPU_ZERO(&mask);
+			CPU_SET(cpu, &mask);
+			if (pthread_setaffinity_np(thread, sizeof(mask), &mask) != 0) {
+				fprintf(stderr, "WARNING: Cannot pin pool thread %u to CPU %u\n", index, cpu);
+			}
+			return;
+		}
+	}
+}
+
+bool init_worker_pool(WorkerPool &pool, unsigned num_threads, bool dynamic, unsigned chunk,
+					  unsigned spin, bool pin) {
+	pool.num_threads = (num_threads == 0) ? 1 : num_threads;
+	pool.dynamic = dynamic;
+	pool.chunk = (chunk == 0) ? 1 : chunk;
+	pool.spin = spin;
+	pool.func = NULL;
+	pool.arg = NULL;
+	pool.num_strands = 0;
+	pool.next_strand.store(0);
+	pool.generation.store(0);
+	pool.sleeping.store(0);
+	pool.remaining.store(0);
+	pool.caller_sleeping.store(0);
+	pool.stop = false;
+	pool.workers = new PoolWorker[pool.num_threads];
+	pool.num_guests = 0;
+	pool.attached_guests = 0;
+	pool.guests = NULL;
+	pool.strand_len = 0;
+
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	if (pin && (sched_getaffinity(0, sizeof(cpus), &cpus) != 0 || (unsigned)CPU_COUNT(&cpus) != pool.num_threads)) {
+		pin = false;
+	}
+
+	for (unsigned i=1; i<pool.num_threads; i++) {
+		pool.workers[i].pool = &pool;
+		pool.workers[i].index = i;
+		if (pthread_create(&pool.workers[i].thread, NULL, worker_main, &pool.workers[i]) != 0) {
+			// Stop the workers started so far
+			pool.num_threads = i;
+			free_worker_pool(pool);
+			return false;
+		}
+		if (pin) pin_thread(pool.workers[i].thread, cpus, i);
+	}
+	if (pin) pin_thread(pthread_self(), cpus, 0);
+
+	return true;
+}
+
+void worker_pool_run(WorkerPool &pool, unsigned num_strands, StrandFunc func, void *arg,
+					 uint64_t strand_len) {
+	pool.func = func;
+	pool.arg = arg;
+	pool.num_strands = num_strands;
+	pool.strand_len = strand_len;
+	pool.next_strand.store(0, memory_order_relaxed);
+	pool.remaining.store(pool.num_threads - 1 + pool.attached_guests, memory_order_relaxed);
+
+	// Publish the segment, then wake up the workers that went to sleep
+	pool.generation.fetch_add(1);
+	if (pool.sleeping.load() != 0) {
+		futex_wake_all(pool.generation);
+	}
+	for (unsigned g=0; g<pool.attached_guests; g++) {
+		PoolWorker &guest = pool.guests[g];
+		guest.dispatch.fetch_add(1);
+		if (guest.sleeping.load() != 0) {
+			futex_wake_all(guest.dispatch);
+		}
+	}
+
+	run_strands(pool, 0);
+
+	// Wait for the workers to finish their strands
+	uint32_t remaining;
+	while ((remaining = pool.remaining.load(memory_order_acquire)) != 0) {
+		wait_while_equal(pool.remaining, remaining, pool.caller_sleeping, pool.spin);
+	}
+}
+
+bool worker_pool_add_guests(WorkerPool &pool, unsigned num_guests) {
+	if (pool.guests != NULL || num_guests == 0) {
+		return pool.guests != NULL;
+	}
+
+	// One priority below the caller, if it has a real-time priority
+	int policy;
+	sched_param sp;
+	bool lower = (pthread_getschedparam(pthread_self(), &policy, &sp) == 0 &&
+				  policy != SCHED_OTHER && sp.sched_priority > 1);
+	sp.sched_priority--;
+
+	pool.guests = new PoolWorker[num_guests];
+	for (unsigned g=0; g<num_guests; g++) {
+		PoolWorker &guest = pool.guests[g];
+		guest.pool = &pool;
+		guest.index = pool.num_threads + g;
+		guest.return_by = 0;
+		guest.dispatch.store(0);
+		guest.sleeping.store(0);
+		if (pthread_create(&guest.thread, NULL, guest_main, &guest) != 0) {
+			pool.num_guests = g;
+			return false;
+		}
+		pool.num_guests = g+1;
+		if (lower && pthread_setschedparam(guest.thread, policy, &sp) != 0) {
+			fprintf(stderr, "WARNING: Cannot lower the priority of pool guest %u\n", g);
+		}
+	}
+	return true;
+}
+
+bool worker_pool_attach_guest(WorkerPool &pool, unsigned cpu, uint64_t return_by) {
+	if (!pool.dynamic || pool.attached_guests >= pool.num_guests) {
+		return false;
+	}
+
+	PoolWorker &guest = pool.guests[pool.attached_guests];
+	cpu_set_t mask;
+	CPU_ZERO(&mask);
+	CPU_SET(cpu, &mask);
+	if (pthread_setaffinity_np(guest.thread, sizeof(mask), &mask) != 0) {
+		return false;
+	}
+	guest.return_by = return_by;
+	pool.attached_guests++;
+	return true;
+}
+
+void worker_pool_detach_guests(WorkerPool &pool) {
+	pool.attached_guests = 0;
+}
+
+void free_worker_pool(WorkerPool &pool) {
+	if (pool.workers == NULL) return;
+
+	pool.stop = true;
+	pool.generation.fetch_add(1);
+	futex_wake_all(pool.generation);
+	for (unsigned i=1; i<pool.num_threads; i++) {
+		pthread_join(pool.workers[i].thread, NULL);
+	}
+	for (unsigned g=0; g<pool.num_guests; g++) {
+		pool.guests[g].dispatch.fetch_add(1);
+		futex_wake_all(pool.guests[g].dispatch);
+		pthread_join(pool.guests[g].thread, NULL);
+	}
+
+	delete[] pool.workers;
+	delete[] pool.guests;
+	pool.workers = NULL;
+	pool.guests = NULL;
+	pool.num_guests = 0;
+	pool.attached_guests = 0;
+}
@@ -0,0 +1,99 @@
+// Pool of persistent worker threads to run the strands of a segment, as an
+// alternative to opening an OpenMP parallel region per segment.
+//
+// The calling thread takes part in every segment as thread 0, and the workers
+// are threads 1 .. num_threads-1. Between segments, the workers spin for a
+// while on a generation counter and then sleep on it with a futex. The caller
+// waits for the workers at the end of a segment the same way. Strands are
+// distributed either as the OpenMP static schedule with chunk 1 (strand s runs
+// on thread s mod num_threads), or as the dynamic schedule, in which threads
+// take chunks of strands from a shared counter.
+//
+// With the dynamic schedule, guest threads can also take strands on CPUs that
+// the task has borrowed from other tasks (see core_lending.h). A guest attached
+// to a CPU takes part in the segments like a worker, but only takes a strand
+// when it can finish it before the CPU must be returned. The guests run one
+// priority below the calling thread, so the owner of the CPU preempts them.
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <atomic>
+
+// Default number of polls before a waiting thread sleeps on a futex
+const unsigned kDefaultPoolSpin = 20000;
+
+// Function run for each strand, with the index of the thread running it
+typedef void (*StrandFunc)(void *arg, unsigned strand, unsigned thread);
+
+typedef struct WorkerPool WorkerPool;
+
+typedef struct PoolWorker {
+	WorkerPool *pool;
+	unsigned index;
+	pthread_t thread;
+	// Guests only: when the borrowed CPU must be returned (CLOCK_MONOTONIC ns),
+	// and the counter incremented to make the guest take part in a segment
+	uint64_t return_by;
+	std::atomic<uint32_t> dispatch;
+	std::atomic<uint32_t> sleeping;
+} PoolWorker;
+
+struct WorkerPool {
+	unsigned num_threads; // including the calling thread
+	bool dynamic;
+	unsigned chunk;
+	unsigned spin;
+	PoolWorker *workers;
+	unsigned num_guests;
+	unsigned attached_guests; // guests 0 .. attached_guests-1 take part in the segments
+	PoolWorker *guests;
+
+	// The current segment
+	StrandFunc func;
+	void *arg;
+	unsigned num_strands;
+	uint64_t strand_len; // ns, the time a guest needs to run a strand
+
+	// Each counter is on its own cache line
+	alignas(64) std::atomic<unsigned> next_strand;
+	alignas(64) std::atomic<uint32_t> generation; // incremented to start a segment
+	alignas(64) std::atomic<uint32_t> sleeping; // workers sleeping on generation
+	alignas(64) std::atomic<uint32_t> remaining; // workers still in the segment
+	alignas(64) std::atomic<uint32_t> caller_sleeping;
+	bool stop;
+};
+
+// Start @num_threads-1 workers. If @dynamic, strands are taken in chunks of
+// @chunk from a shared counter, otherwise they are assigned round-robin.
+// If @pin and the calling thread may run on exactly num_threads CPUs, each
+// thread (the caller included) is pinned to one of them.
+// The workers inherit the scheduling policy of the calling thread.
+// Return false if the workers cannot be started.
+bool init_worker_pool(WorkerPool &pool, unsigned num_threads, bool dynamic, unsigned chunk = 1,
+					  unsigned spin = kDefaultPoolSpin, bool pin = true);
+
+// Run @func for strands 0 .. @num_strands-1 on the pool and return when
+// all of them have finished. Must be called by the thread that created the pool.
+// Guests run strands of length @strand_len (ns) only if they can finish them in time.
+void worker_pool_run(WorkerPool &pool, unsigned num_strands, StrandFunc func, void *arg,
+					 uint64_t strand_len = 0);
+
+// Start @num_guests guest threads, detached. Their thread indexes follow
+// those of the workers. Return false if they cannot all be started.
+bool worker_pool_add_guests(WorkerPool &pool, unsigned num_guests);
+
+// Attach the next detached guest to @cpu until @return_by (CLOCK_MONOTONIC
+// ns). Return false if there is no detached guest or the schedule is static.
+// Guests are attached and detached between segments, by the calling thread.
+bool worker_pool_attach_guest(WorkerPool &pool, unsigned cpu, uint64_t return_by);
+
+// Detach all the guests
+void worker_pool_detach_guests(WorkerPool &pool);
+
+// Stop and join the workers
+void free_worker_pool(WorkerPool &pool);
+
+#endif // WORKER_POOL_H
@@ -0,0 +1,276 @@
+// Memory- and cache-sensitive workloads for the strands of synthetic tasks.
+// See workload.h.
+
+#include <stdlib.h>
+#include <string.h>
+#include "workload.h"
+#include "work_kernel.h"
+
+using namespace std;
+
+const size_t kCacheLine = 64;
+
+// Default working sets per strand
+const size_t kDefaultWorkingSets[] = {
+	64 << 20, // stream
+	16 << 20, // chase
+	4 << 10, // simd
+	256 << 10 // cache
+};
+
+// A calibration run is doubled until it takes this long, and the fastest of
+// kCalibrationRuns runs of that size gives the rate
+const uint64_t kCalibrationNs = 2000000;
+const unsigned kCalibrationRuns = 3;
+
+// Doubles of each array in a cache line (stream)
+const size_t kLineDoubles = kCacheLine / sizeof(double);
+
+// A link of the chain followed by chase, one per cache line
+typedef struct ChaseLine {
+	size_t next;
+	char pad[kCacheLine - sizeof(size_t)];
+} ChaseLine;
+
+// Vectors of the simd workload, split into the machine's vector registers by the compiler
+typedef float SimdVector __attribute__((vector_size(32)));
+const size_t kLineVectors = kCacheLine / sizeof(SimdVector);
+const unsigned kSimdRounds = 8;
+
+// Words mixed by the cache workload in a cache line
+const size_t kLineWords = kCacheLine / sizeof(uint64_t);
+
+bool parse_workload(const string &arg, WorkloadSpec &spec) {
+	const char *names[] = {"stream", "chase", "simd", "cache"};
+	string name = arg.substr(0, arg.find(':'));
+
+	unsigned kernel;
+	for (kernel=0; kernel<4; kernel++) {
+		if (name == names[kernel]) break;
+	}
+	if (kernel == 4) {
+		return false;
+	}
+	spec.kernel = (Workload_Kernel) kernel;
+	spec.working_set = kDefaultWorkingSets[kernel];
+
+	if (name.size() == arg.size()) {
+		return true;
+	}
+
+	// Working set size with an optional K, M or G suffix
+	const char *size = arg.c_str() + name.size() + 1;
+	char *end;
+	unsigned long long working_set = strtoull(size, &end, 10);
+	if (end == size) {
+		return false;
+	}
+	switch (*end) {
+	case 'G': working_set <<= 10; // fall through
+	case 'M': working_set <<= 10; // fall through
+	case 'K': working_set <<= 10; end++; break;
+	case '\0': break;
+	default: return false;
+	}
+	if (*end != '\0' || working_set < 2*kCacheLine) {
+		return false;
+	}
+	spec.working_set = working_set;
+	return true;
+}
+
+// Bytes of the working set actually used: whole cache lines, and for stream
+// the same number of lines for both arrays
+static size_t used_bytes(const WorkloadSpec &spec) {
+	size_t unit = (spec.kernel == WORKLOAD_STREAM) ? 2*kCacheLine : kCacheLine;
+	return spec.working_set / unit * unit;
+}
+
+// Link the cache lines of a working set into a random cycle (Sattolo's
+// algorithm), so that the hardware prefetchers cannot follow the chain
+static void init_chase_lines(ChaseLine *lines, size_t num_lines, uint64_t seed) {
+	for (size_t i=0; i<num_lines; i++) {
+		lines[i].next = i;
+	}
+	uint64_t x = seed*2 + 1;
+	for (size_t i=num_lines-1; i>0; i--) {
+		x = x*6364136223846793005ULL + 1442695040888963407ULL;
+		size_t j = (x >> 33) % i;
+		size_t tmp = lines[i].next;
+		lines[i].next = lines[j].next;
+		lines[j].next = tmp;
+	}
+}
+
+static void init_strand(const WorkloadSpec &spec, WorkloadStrand &strand, size_t size, unsigned index) {
+	strand.cursor = 0;
+	switch (spec.kernel) {
+	case WORKLOAD_STREAM: {
+		double *a = (double*) strand.buffer;
+		for (size_t i=0; i<size/sizeof(double); i++) {
+			a[i] = 1.0;
+		}
+		break;
+	}
+	case WORKLOAD_CHASE:
+		init_chase_lines((ChaseLine*) strand.buffer, size/kCacheLine, index);
+		break;
+	case WORKLOAD_SIMD: {
+		float *v = (float*) strand.buffer;
+		for (size_t i=0; i<size/sizeof(float); i++) {
+			v[i] = 1.0f;
+		}
+		break;
+	}
+	default:
+		memset(strand.buffer, (int)index, size);
+		break;
+	}
+}
+
+static void stream_units(WorkloadStrand &strand, size_t size, uint64_t units) {
+	size_t n = size / (2*sizeof(double));
+	double *a = (double*) strand.buffer;
+	const double *b = a + n;
+	size_t i = strand.cursor;
+	uint64_t remaining = units * kLineDoubles;
+	while (remaining > 0) {
+		size_t end = (n - i < remaining) ? n : i + remaining;
+		remaining -= end - i;
+		for (; i<end; i++) {
+			a[i] = a[i]*0.5 + b[i];
+		}
+		if (i == n) i = 0;
+	}
+	strand.cursor = i;
+}
+
+static void chase_units(WorkloadStrand &strand, uint64_t units) {
+	const ChaseLine *lines = (const ChaseLine*) strand.buffer;
+	size_t p = strand.cursor;
+	for (uint64_t u=0; u<units; u++) {
+		p = lines[p].next;
+	}
+	strand.cursor = p;
+}
+
+static void simd_units(WorkloadStrand &strand, size_t size, uint64_t units) {
+	const SimdVector m = {0.999f, 0.999f, 0.999f, 0.999f, 0.999f, 0.999f, 0.999f, 0.999f};
+	const SimdVector c = {0.001f, 0.001f, 0.001f, 0.001f, 0.001f, 0.001f, 0.001f, 0.001f};
+	size_t num_vectors = size / sizeof(SimdVector);
+	SimdVector *v = (SimdVector*) strand.buffer;
+	size_t i = strand.cursor;
+	for (uint64_t u=0; u<units; u++) {
+		SimdVector x = v[i], y = v[i+1];
+		for (unsigned r=0; r<kSimdRounds; r++) {
+			x = x*m + c;
+			y = y*m + c;
+		}
+		v[i] = x;
+		v[i+1] = y;
+		i += kLineVectors;
+		if (i >= num_vectors) i = 0;
+	}
+	strand.cursor = i;
+}
+
+static void cache_units(WorkloadStrand &strand, size_t size, uint64_t units) {
+	size_t num_words = size / sizeof(uint64_t);
+	uint64_t *w = (uint64_t*) strand.buffer;
+	size_t i = strand.cursor;
+	for (uint64_t u=0; u<units; u++) {
+		for (size_t k=0; k<kLineWords; k++) {
+			uint64_t x = w[i+k];
+			w[i+k] = (x ^ (x >> 29)) * 0xbf58476d1ce4e5b9ULL + k;
+		}
+		i += kLineWords;
+		if (i >= num_words) i = 0;
+	}
+	strand.cursor = i;
+}
+
+static void run_units(Workload &workload, unsigned strand, uint64_t units) {
+	WorkloadStrand &s = workload.strands[strand];
+	size_t size = used_bytes(workload.spec);
+	switch (workload.spec.kernel) {
+	case WORKLOAD_STREAM:
+		stream_units(s, size, units);
+		break;
+	case WORKLOAD_CHASE:
+		chase_units(s, units);
+		break;
+	case WORKLOAD_SIMD:
+		simd_units(s, size, units);
+		break;
+	default:
+		cache_units(s, size, units);
+		break;
+	}
+}
+
+static double calibrate_workload(Workload &workload) {
+	// Find a run long enough to be measured
+	uint64_t units = 1024, duration = 0;
+	while (true) {
+		uint64_t start = thread_cpu_time();
+		run_units(workload, 0, units);
+		duration = thread_cpu_time() - start;
+		if (duration >= kCalibrationNs) break;
+		units *= 2;
+	}
+
+	// The fastest run is the one least disturbed by interrupts
+	for (unsigned i=0; i<kCalibrationRuns; i++) {
+		uint64_t start = thread_cpu_time();
+		run_units(workload, 0, units);
+		uint64_t run = thread_cpu_time() - start;
+		if (run < duration) duration = run;
+	}
+	if (duration == 0) duration = 1;
+
+	workload.strands[0].cursor = 0;
+	return (double)units/duration;
+}
+
+bool init_workload(Workload &workload, const WorkloadSpec &spec, unsigned num_strands) {
+	workload.spec = spec;
+	workload.num_strands = 0;
+	workload.strands = NULL;
+	workload.units_per_ns = 0;
+
+	void *strands;
+	if (num_strands == 0 || posix_memalign(&strands, 64, num_strands * sizeof(WorkloadStrand)) != 0) {
+		return false;
+	}
+	workload.strands = (WorkloadStrand*) strands;
+
+	size_t size = used_bytes(spec);
+	for (unsigned i=0; i<num_strands; i++) {
+		void *buffer;
+		if (posix_memalign(&buffer, kCacheLine, size) != 0) {
+			free_workload(workload);
+			return false;
+		}
+		workload.strands[i].buffer = (char*) buffer;
+		workload.num_strands = i+1;
+		init_strand(spec, workload.strands[i], size, i);
+	}
+
+	workload.units_per_ns = calibrate_workload(workload);
+	return true;
+}
+
+void workload_run(Workload &workload, unsigned strand, uint64_t len) {
+	run_units(workload, strand, (uint64_t)(len * workload.units_per_ns));
+}
+
+void free_workload(Workload &workload) {
+	if (workload.strands != NULL) {
+		for (unsigned i=0; i<workload.num_strands; i++) {
+			free(workload.strands[i].buffer);
+		}
+		free(workload.strands);
+		workload.strands = NULL;
+	}
+	workload.num_strands = 0;
+}
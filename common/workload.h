@@ -0,0 +1,74 @@
+// Memory- and cache-sensitive workloads for the strands of synthetic tasks.
+//
+// The work kernels of work_kernel.h only spin on the CPU, so a strand loses
+// nothing when it migrates. A segment can instead run one of these workloads,
+// given after the segment's length on the task's command line:
+//   num-strands len-sec len-ns [workload[:working-set]]
+// where the working set is a size in bytes per strand, with an optional K, M
+// or G suffix:
+//   stream   streams through two arrays, a[i] = a[i]*s + b[i] (memory bandwidth);
+//            64M by default
+//   chase    follows a random cyclic chain of cache lines (memory latency);
+//            16M by default
+//   simd     multiply-adds on vectors of floats (vector units); 4K by default,
+//            so it stays in the L1 cache
+//   cache    mixes the 64-bit words of a working set that stays in the L2
+//            cache (cache-resident compute); 256K by default
+// Each strand of the segment has its own working set, allocated and touched
+// by init, and keeps its position in it from one job to the next, so that a
+// short segment does not run on a cache-warm prefix of its working set.
+// The segments with the same workload share their working sets, since they
+// do not run at the same time.
+//
+// A workload runs in units of a few cache lines. Its rate (units per ns of
+// CPU time) is calibrated at init on a warm working set, on the CPU the task
+// starts on, so a strand takes its segment's length when it runs undisturbed
+// and longer when it has to refill its caches after a migration or competes
+// with other strands for memory bandwidth.
+
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+enum Workload_Kernel {
+	WORKLOAD_STREAM = 0,
+	WORKLOAD_CHASE = 1,
+	WORKLOAD_SIMD = 2,
+	WORKLOAD_CACHE = 3
+};
+
+typedef struct WorkloadSpec {
+	Workload_Kernel kernel;
+	size_t working_set; // bytes per strand
+} WorkloadSpec;
+
+// Working set of a strand, and its position in it
+typedef struct WorkloadStrand {
+	char *buffer;
+	size_t cursor;
+} __attribute__((aligned(64))) WorkloadStrand;
+
+typedef struct Workload {
+	WorkloadSpec spec;
+	unsigned num_strands;
+	WorkloadStrand *strands;
+	double units_per_ns;
+} Workload;
+
+// Parse a workload argument, e.g., "chase:8M". Return false if it is malformed.
+bool parse_workload(const std::string &arg, WorkloadSpec &spec);
+
+// Allocate and touch the working sets of @num_strands strands, and calibrate
+// the workload. Takes a few tens of milliseconds. Return false on failure.
+bool init_workload(Workload &workload, const WorkloadSpec &spec, unsigned num_strands);
+
+// Run the workload on the working set of strand @strand for @len ns of CPU time
+void workload_run(Workload &workload, unsigned strand, uint64_t len);
+
+// Free the working sets
+void free_workload(Workload &workload);
+
+#endif // WORKLOAD_H
@@ -0,0 +1,405 @@
+// This file runs an FS campaign: all the .rtps task sets of the given
+// directories, with as many task sets at a time as there are clusters of
+// the task sets' size in the machine, instead of one at a time as run.sh does.
+//
+// Usage: ./campaign [-m machine_cores] [-t topology] [-k max_clusters] [-l launcher] [-d delay_sec]
+//                   [-o summary_file] {directory | rtps_file} ...
+//
+// The machine's cores are tiled into k disjoint slots of C cores, where C is
+// the largest system core range of the task sets and k = machine_cores/C
+// (at most max_clusters). The slots are placed on the machine topology (read
+// from sysfs, or from a topology file with -t, or "-t flat" for consecutive
+// cores; the first machine_cores CPUs with -m) as the clusters of a task set
+// are, so that they do not share physical cores, and straddle LLCs or nodes
+// only if they must. Each slot takes the next task set from a shared queue,
+// and runs the launcher (./clustering_launcher_fs by default) on a copy of
+// its .rtps file whose clusters are placed again on the slot's CPUs, with the
+// slot number as cluster id so that the slots' barriers do not collide. The
+// copies are written to a "campaign" folder next to the task sets, with a link
+// to the task set's output folder, so the results land where the launcher
+// would write them for the original file. After a run, the slot waits for
+// delay_sec seconds (2 by default, as run.sh) before taking the next task set.
+//
+// Task sets that FS cannot schedule (status 2) are skipped. The exit status
+// of every run is written to the summary file (campaign_summary.txt in the
+// current folder by default).
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <errno.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "taskset_io.h"
+#include "parallel_for.h"
+#include "partition.h"
+#include "topology.h"
+
+using namespace std;
+
+// Status of a task set run, in addition to the launcher's exit status
+enum Campaign_Run_Status {
+	CAMPAIGN_NOT_RUN = -1, // status of the task sets not run yet
+	CAMPAIGN_SKIPPED = -2, // the task set is not schedulable with FS
+	CAMPAIGN_FILE_ERROR = -3, // the task set or its copy could not be read or written
+	CAMPAIGN_LAUNCH_ERROR = -4, // the launcher could not be started
+	CAMPAIGN_SIGNALED = -5 // the launcher was terminated by a signal
+};
+
+typedef struct {
+	string base; // path to the .rtps file without extension
+	int slot;
+	int status;
+	double duration; // wall time of the run (seconds)
+} CampaignRun;
+
+// Return the directory and file name parts of a path
+static void split_path(const string &path, string &dir, string &name) {
+	size_t pos = path.rfind('/');
+	if (pos == string::npos) {
+		dir = ".";
+		name = path;
+	} else {
+		dir = path.substr(0, pos);
+		name = path.substr(pos+1);
+	}
+}
+
+// The CPUs @cpus of @topology. Return false if some of them are not in it.
+static bool select_cpus(const Topology &topology, const vector<unsigned> &cpus, Topology &selected) {
+	selected.cpus.clear();
+	for (unsigned i=0; i<topology.cpus.size(); i++) {
+		if (find(cpus.begin(), cpus.end(), topology.cpus[i].cpu) != cpus.end()) {
+			selected.cpus.push_back(topology.cpus[i]);
+		}
+	}
+	return selected.cpus.size() == cpus.size();
+}
+
+// Split the CPUs of @topology into @num_slots slots of @slot_size CPUs each,
+// placed as the clusters of a task set. Return false if they do not fit.
+static bool place_slots(const Topology &topology, unsigned num_slots, unsigned slot_size,
+						vector<vector<unsigned> > &slot_cpus) {
+	TaskSet slots;
+	for (unsigned s=0; s<num_slots; s++) {
+		Task slot = Task();
+		slot.id = s + 1;
+		slot.first_core = 0;
+		slot.last_core = slot_size - 1;
+		slot.pooled = false;
+		slots.taskset[slot.id] = slot;
+	}
+	if (!place_clusters(slots, topology)) {
+		return false;
+	}
+
+	slot_cpus.resize(num_slots);
+	for (unsigned s=0; s<num_slots; s++) {
+		slot_cpus[s] = slots.taskset[s + 1].cpus;
+	}
+	return true;
+}
+
+// Write a copy of the task set with its clusters placed on the CPUs of
+// @slot, keeping their sizes and the tasks without cores.
+// Return the path of the copy without extension, or an empty string on failure.
+static string write_placed_rtps(const string &base, const TaskSetSpec &ts, const Topology &slot) {
+	string dir, name;
+	split_path(base, dir, name);
+	string campaign_dir = dir + "/campaign";
+	if (!make_dir(campaign_dir)) {
+		return "";
+	}
+
+	TaskSet placed;
+	for (unsigned i=0; i<ts.tasks.size(); i++) {
+		const TaskSpec &task_spec = ts.tasks[i];
+		Task task = Task();
+		task.id = i + 1;
+		task.first_core = task_spec.first_core;
+		task.last_core = task_spec.last_core;
+		if (!task_spec.cpus.empty()) {
+			task.first_core = 0;
+			task.last_core = task_spec.cpus.size() - 1;
+		}
+		task.pooled = task_spec.edf_pool;
+		placed.taskset[task.id] = task;
+	}
+	if (!place_clusters(placed, slot)) {
+		cerr << "ERROR: The clusters of " << base << " do not fit in a slot" << endl;
+		return "";
+	}
+
+	// The launcher writes to <copy>_output, which links to the original output folder
+	string copy_base = campaign_dir + "/" + name;
+	string output_link = copy_base + "_output";
+	string output_target = "../" + name + "_output";
+	if (symlink(output_target.c_str(), output_link.c_str()) != 0 && errno != EEXIST) {
+		cerr << "ERROR: Cannot link " << output_link << " to the output folder" << endl;
+		return "";
+	}
+
+	ofstream ofs((copy_base + ".rtps").c_str());
+	if (!ofs.is_open()) {
+		cerr << "ERROR: Cannot write " << copy_base << ".rtps" << endl;
+		return "";
+	}
+
+	ofs << ts.status << "\n";
+	ofs << slot.cpus.front().cpu << " " << slot.cpus.back().cpu << "\n";
+	for (unsigned i=0; i<ts.tasks.size(); i++) {
+		const TaskSpec &task_spec = ts.tasks[i];
+		const Task &task = placed.taskset[i + 1];
+		ofs << task_spec.command_line << "\n";
+		ofs << task_spec.timing_line << "\n";
+		ofs << task.first_core << " " << task.last_core << " " << task_spec.priority;
+		if (!task.cpus.empty()) {
+			ofs << " " << format_cpu_list(task.cpus);
+		}
+		ofs << (task_spec.edf_pool ? " edf" : "") << "\n";
+	}
+
+	ofs.close();
+	return ofs.fail() ? "" : copy_base;
+}
+
+// Run the launcher on a task set copy in slot @slot. Return the launcher's
+// exit status, or a Campaign_Run_Status.
+static int run_launcher(const string &launcher, const string &copy_base, unsigned slot,
+						const vector<unsigned> &cpus) {
+	ostringstream cluster_id;
+	cluster_id << slot;
+
+	pid_t pid = fork();
+	if (pid == 0) {
+		// The launcher kills its process group on errors, so give it its own
+		setpgid(0, 0);
+
+		// Keep the launcher itself off the other slots' cores
+		cpu_set_t mask;
+		CPU_ZERO(&mask);
+		for (unsigned i=0; i<cpus.size(); i++) {
+			CPU_SET(cpus[i], &mask);
+		}
+		sched_setaffinity(0, sizeof(mask), &mask);
+
+		execl(launcher.c_str(), launcher.c_str(), copy_base.c_str(), cluster_id.str().c_str(), (char*) NULL);
+		perror("Execv-ing the launcher failed");
+		_exit(127);
+	} else if (pid == -1) {
+		perror("Forking the launcher failed");
+		return CAMPAIGN_LAUNCH_ERROR;
+	}
+
+	int status;
+	while (waitpid(pid, &status, 0) == -1) {
+		if (errno != EINTR) {
+			return CAMPAIGN_LAUNCH_ERROR;
+		}
+	}
+
+	if (WIFEXITED(status)) {
+		return WEXITSTATUS(status);
+	}
+	return CAMPAIGN_SIGNALED;
+}
+
+static double elapsed_sec(const timespec &start) {
+	timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+static void usage(const char *prog) {
+	cerr << "Usage: " << prog << " [-m machine_cores] [-t topology] [-k max_clusters] [-l launcher] [-d delay_sec]"
+		 << " [-o summary_file] {directory | rtps_file} ..." << endl;
+}
+
+int main(int argc, char *argv[]) {
+	unsigned machine_cores = 0; // all the CPUs of the topology by default
+	string topology_file;
+	unsigned max_clusters = 0;
+	string launcher = "./clustering_launcher_fs";
+	unsigned delay = 2;
+	string summary_file = "campaign_summary.txt";
+
+	int opt;
+	while ((opt = getopt(argc, argv, "m:t:k:l:d:o:h")) != -1) {
+		switch (opt) {
+		case 'm':
+			machine_cores = atoi(optarg);
+			break;
+		case 't':
+			topology_file = optarg;
+			break;
+		case 'k':
+			max_clusters = atoi(optarg);
+			break;
+		case 'l':
+			launcher = optarg;
+			break;
+		case 'd':
+			delay = atoi(optarg);
+			break;
+		case 'o':
+			summary_file = optarg;
+			break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (optind >= argc) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	// The machine topology, restricted to its first machine_cores CPUs
+	Topology machine;
+	if (topology_file.empty()) {
+		if (!read_sysfs_topology(machine)) {
+			cerr << "WARNING: Cannot read the topology from sysfs, using consecutive cores" << endl;
+			flat_topology(0, default_num_workers() - 1, machine);
+		}
+	} else if (topology_file == "flat") {
+		flat_topology(0, ((machine_cores != 0) ? machine_cores : default_num_workers()) - 1, machine);
+	} else if (!read_topology_file(topology_file, machine)) {
+		return 1;
+	}
+	if (machine_cores == 0 || machine_cores > machine.cpus.size()) {
+		machine_cores = machine.cpus.size();
+	}
+	machine.cpus.resize(machine_cores);
+
+	// Collect the task sets, in the order of their numbers within each directory
+	vector<CampaignRun> runs;
+	for (int i=optind; i<argc; i++) {
+		string path(argv[i]);
+		vector<string> files;
+		if (is_directory(path)) {
+			files = list_files(path, ".rtps");
+		} else {
+			files.push_back(path);
+		}
+
+		for (unsigned j=0; j<files.size(); j++) {
+			CampaignRun run;
+			string &file = files[j];
+			run.base = (file.size() > 5 && file.compare(file.size()-5, 5, ".rtps") == 0) ?
+				file.substr(0, file.size()-5) : file;
+			run.slot = -1;
+			run.status = CAMPAIGN_NOT_RUN;
+			run.duration = 0;
+			runs.push_back(run);
+		}
+	}
+
+	// Size the slots for the largest task set
+	vector<TaskSetSpec> tasksets(runs.size());
+	unsigned cluster_cores = 1;
+	for (unsigned i=0; i<runs.size(); i++) {
+		if (!read_rtps(runs[i].base + ".rtps", tasksets[i])) {
+			runs[i].status = CAMPAIGN_FILE_ERROR;
+			continue;
+		}
+		unsigned num_cores = tasksets[i].sys_last_core - tasksets[i].sys_first_core + 1;
+		if (num_cores > cluster_cores) cluster_cores = num_cores;
+	}
+
+	if (cluster_cores > machine_cores) {
+		cerr << "ERROR: Task sets need " << cluster_cores << " cores, the machine has " << machine_cores << endl;
+		return 1;
+	}
+
+	unsigned num_slots = machine_cores / cluster_cores;
+	if (max_clusters != 0 && num_slots > max_clusters) num_slots = max_clusters;
+	vector<vector<unsigned> > slot_cpus;
+	vector<Topology> slot_topologies(num_slots);
+	if (!place_slots(machine, num_slots, cluster_cores, slot_cpus)) {
+		cerr << "ERROR: Cannot place " << num_slots << " clusters of " << cluster_cores << " cores" << endl;
+		return 1;
+	}
+	for (unsigned s=0; s<num_slots; s++) {
+		select_cpus(machine, slot_cpus[s], slot_topologies[s]);
+	}
+	cerr << "Running " << runs.size() << " task sets on " << num_slots << " clusters of "
+		 << cluster_cores << " cores" << endl;
+
+	// Each slot takes the next task set from the queue as soon as it is free
+	atomic<unsigned> next(0);
+	mutex print_lock;
+	vector<thread> slots;
+	for (unsigned s=0; s<num_slots; s++) {
+		slots.push_back(thread([&, s]() {
+			string cpu_list = format_cpu_list(slot_cpus[s]);
+			unsigned i;
+			while ((i = next.fetch_add(1)) < runs.size()) {
+				CampaignRun &run = runs[i];
+				const TaskSetSpec &ts = tasksets[i];
+				if (run.status == CAMPAIGN_FILE_ERROR) continue;
+				if (ts.status == 2) {
+					run.status = CAMPAIGN_SKIPPED;
+					continue;
+				}
+
+				run.slot = s;
+				string copy_base = write_placed_rtps(run.base, ts, slot_topologies[s]);
+				if (copy_base.empty() || !make_dir(run.base + "_output")) {
+					run.status = CAMPAIGN_FILE_ERROR;
+					continue;
+				}
+
+				timespec start;
+				clock_gettime(CLOCK_MONOTONIC, &start);
+				run.status = run_launcher(launcher, copy_base, s, slot_cpus[s]);
+				run.duration = elapsed_sec(start);
+
+				{
+					lock_guard<mutex> guard(print_lock);
+					cerr << "Cluster " << s << " (cores " << cpu_list << ") finished " << run.base << " with status " << run.status << endl;
+				}
+
+				if (delay > 0) sleep(delay);
+			}
+		}));
+	}
+
+	for (unsigned s=0; s<slots.size(); s++) {
+		slots[s].join();
+	}
+
+	// Write the summary: one line per task set, then the number of failed runs
+	ofstream ofs(summary_file.c_str());
+	if (!ofs.is_open()) {
+		cerr << "ERROR: Cannot write summary file " << summary_file << endl;
+	}
+
+	unsigned num_failed = 0, num_skipped = 0;
+	ofs << "# taskset cluster status duration_sec" << endl;
+	for (unsigned i=0; i<runs.size(); i++) {
+		if (runs[i].status == CAMPAIGN_SKIPPED) {
+			num_skipped++;
+		} else if (runs[i].status != 0) {
+			num_failed++;
+		}
+		ofs << runs[i].base << " " << runs[i].slot << " " << runs[i].status << " " << runs[i].duration << endl;
+	}
+	ofs << "# failed " << num_failed << " skipped " << num_skipped << " total " << runs.size() << endl;
+	ofs.close();
+
+	cerr << "FEDERATED SCHEDULING campaign finished: " << num_failed << " failed, "
+		 << num_skipped << " skipped, " << runs.size() << " task sets" << endl;
+	return (num_failed == 0) ? 0 : 2;
+}
@@ -5,6 +5,7 @@
 #include <sstream>
 #include <string>
 #include <unistd.h>
+#include <stdlib.h>
 #include <stdio.h>
 #include <errno.h>
 #include <vector>
@@ -16,6 +17,9 @@
 #include <sys/stat.h>
 #include <signal.h>
 #include "single_use_barrier.h"
+#include "task_env.h"
+#include "edf_pool.h"
+#include "core_lending.h"
 
 enum rt_gomp_clustering_launcher_error_codes
 { 
@@ -53,6 +57,12 @@ int main(int argc, char *argv[])
 	// Define the name of the barrier used for synchronizing tasks after creation
 	std::string barrier_name = "/RT_GOMP_CLUSTERING_BARRIER";
 
+	// Define the name of the table shared by the tasks of the EDF pool of a hybrid partition
+	std::string edf_pool_name = "/RT_GOMP_EDF_POOL";
+
+	// Define the name of the board on which the tasks lend their idle CPUs when reclaiming
+	std::string lending_board_name = "/RT_GOMP_LENDING_BOARD";
+
 	// Verify the number of arguments
 	// First argument (mandatory): path to a rtps file without the .rtps extension
 	// Second argument (optional): the cluster number of this cluster. This is used 
@@ -69,6 +79,8 @@ int main(int argc, char *argv[])
 	// Append the third argument to the names of the shared memory objects
 	if (argc == 3) {
 		barrier_name += argv[2];
+		edf_pool_name += argv[2];
+		lending_board_name += argv[2];
 	}
 	
 	// Determine the schedule (.rtps) filenames from the program argument
@@ -110,6 +122,8 @@ int main(int argc, char *argv[])
 				fprintf(stderr, "Taskset is schedulable with FS: %s\n", argv[1]);
 			} else if (schedulability == 1) {
 				fprintf(stderr, "WARNING: Taskset may not be schedulable with FS: %s\n", argv[1]);
+			} else if (schedulability == 3) {
+				fprintf(stderr, "Taskset is schedulable with FS and a shared EDF pool: %s\n", argv[1]);
 			} else {
 				fprintf(stderr, "WARNING: Taskset NOT schedulable with FS: %s", argv[1]);
 				return RT_GOMP_CLUSTERING_LAUNCHER_UNSCHEDULABLE_ERROR;
@@ -141,6 +155,20 @@ int main(int argc, char *argv[])
 		return RT_GOMP_CLUSTERING_LAUNCHER_BARRIER_INITIALIZATION_ERROR;
 	}
 	
+	// The table of the EDF pool is created for the first task of the pool
+	EdfPool *edf_pool = NULL;
+
+	// With RT_GOMP_RECLAIM=1, the tasks with dedicated cores lend and borrow
+	// idle CPUs on a shared board (see core_lending.h)
+	LendingBoard *lending_board = NULL;
+	const char *reclaim = getenv("RT_GOMP_RECLAIM");
+	if (reclaim != NULL && strcmp(reclaim, "1") == 0) {
+		lending_board = create_lending_board(lending_board_name.c_str());
+		if (lending_board == NULL) {
+			perror("WARNING: Creating the lending board failed, reclaiming disabled");
+		}
+	}
+
 	// Iterate over the tasks and fork and execv each one
 	std::string task_command_line, task_timing_line, task_partition_line;
 	for (unsigned t = 1; t <= num_tasks; ++t)
@@ -185,8 +213,30 @@ int main(int argc, char *argv[])
 				}
 			}
 			
+			// An explicit CPU list may follow, which the task manager takes in
+			// place of the first core, and the marker of the tasks of the EDF
+			// pool (see taskset_io.h)
+			bool in_edf_pool = false;
+			if (task_partition_stream >> partition_param && partition_param != "edf") {
+				task_manager_argvector[1] = partition_param;
+				task_partition_stream >> partition_param;
+			}
+			if (task_partition_stream && partition_param == "edf") {
+				in_edf_pool = true;
+				task_partition_stream >> partition_param;
+			}
+
+			if (in_edf_pool && edf_pool == NULL) {
+				edf_pool = create_edf_pool(edf_pool_name.c_str());
+				if (edf_pool == NULL) {
+					perror("ERROR: Creating the EDF pool failed");
+					kill(0, SIGTERM);
+					return RT_GOMP_CLUSTERING_LAUNCHER_BARRIER_INITIALIZATION_ERROR;
+				}
+			}
+
 			// Check for extra partition parameters
-			if (task_partition_stream >> partition_param) {
+			if (task_partition_stream) {
 				fprintf(stderr, "ERROR: Too many partition parameters were provided for task %s", program_name.c_str());
 				kill(0, SIGTERM);
 				return RT_GOMP_CLUSTERING_LAUNCHER_FILE_PARSE_ERROR;
@@ -258,6 +308,21 @@ int main(int argc, char *argv[])
 				} else {
 					perror("Redirecting STDOUT failed.");
 				}
+
+				// Per-task options derived from the experiment-wide ones, e.g.,
+				// the files for binary job records or strand traces (see task_env.h)
+				TaskEnv task_env;
+				task_output_env(out_folder, t, "", task_env);
+
+				// The threads of a pool task must not spin on other tasks' cores
+				// while they wait for work
+				if (in_edf_pool) {
+					task_env["RT_GOMP_EDF_POOL"] = edf_pool_name;
+					task_env["OMP_WAIT_POLICY"] = "passive";
+				} else if (lending_board != NULL) {
+					task_env["RT_GOMP_LENDING_BOARD"] = lending_board_name;
+				}
+				export_task_env(task_env);
                 
 				// Const cast is necessary for type compatibility. Since the strings are
 				// not shared, there is no danger in removing the const modifier.
@@ -304,6 +369,13 @@ int main(int argc, char *argv[])
 	}
 
 
+	if (edf_pool != NULL) {
+		close_edf_pool(edf_pool, edf_pool_name.c_str());
+	}
+	if (lending_board != NULL) {
+		close_lending_board(lending_board, lending_board_name.c_str());
+	}
+
 	fprintf(stderr, "All tasks finished\n");
 	return 0;
 }
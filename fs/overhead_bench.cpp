@@ -0,0 +1,237 @@
+// This file measures the overheads of the experiment harness on the local
+// machine and writes them as an overhead profile (see overhead_profile.h):
+//   get_time             cost of a get_time call (ns)
+//   sleep_until_ts       wake-up latency of sleep_until_ts past the requested time,
+//                        i.e., the release latency of FS jobs (ns)
+//   busy_work_<len>      achieved over requested length of busy_work for a
+//                        requested length of <len> ns (ppm)
+//   omp_static_<n>       entry/exit of an OpenMP parallel region of n threads
+//   omp_dynamic_<n>      with n empty strands and the static or dynamic schedule
+//                        with chunk 1, as used under GEDF and FS (ns)
+//   launch_to_barrier    from the fork of a task process by the launcher to the
+//                        release of the barrier the tasks wait on (ns)
+//
+// Usage: ./overhead_bench [-o profile_file] [-n num_samples] [-r]
+// With -r, the measurements run under SCHED_FIFO priority 97, as FS tasks do.
+// The sleep, busy-work and launch measurements use num_samples/100 samples.
+// Liblitmus' sleep_next_period is not measured since it needs a Litmus^RT kernel.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <omp.h>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include "timespec_functions.h"
+#include "single_use_barrier.h"
+#include "latency_histogram.h"
+#include "overhead_profile.h"
+
+using namespace std;
+
+// Argument that makes the program act as a launched task (see measure_launch)
+const char *kBarrierChildArg = "--barrier-child";
+
+// Requested busy_work lengths (ns)
+const unsigned long kBusyWorkLengths[] = {10000, 100000, 1000000, 10000000};
+
+uint64_t timespec_to_ns(const timespec &ts) {
+	return (uint64_t)ts.tv_sec*1000000000 + ts.tv_nsec;
+}
+
+timespec ns_to_ts(uint64_t ns) {
+	timespec ts;
+	ts.tv_sec = ns/1000000000;
+	ts.tv_nsec = ns%1000000000;
+	return ts;
+}
+
+uint64_t now_ns() {
+	timespec now;
+	get_time(&now);
+	return timespec_to_ns(now);
+}
+
+void measure_get_time(unsigned num_samples, vector<OverheadEntry> &profile) {
+	LatencyHistogram hist;
+	init_histogram(hist);
+	for (unsigned i=0; i<num_samples; i++) {
+		timespec first, second;
+		get_time(&first);
+		get_time(&second);
+		histogram_record(hist, timespec_to_ns(second) - timespec_to_ns(first));
+	}
+	profile.push_back(make_overhead_entry("get_time", "ns", hist));
+}
+
+void measure_sleep(unsigned num_samples, vector<OverheadEntry> &profile) {
+	LatencyHistogram hist;
+	init_histogram(hist);
+	for (unsigned i=0; i<num_samples; i++) {
+		// Sleep until 1ms from now, as a task waits for its next release
+		uint64_t release = now_ns() + 1000000;
+		sleep_until_ts(ns_to_ts(release));
+		uint64_t wake_up = now_ns();
+		histogram_record(hist, (wake_up > release) ? wake_up - release : 0);
+	}
+	profile.push_back(make_overhead_entry("sleep_until_ts", "ns", hist));
+}
+
+void measure_busy_work(unsigned num_samples, vector<OverheadEntry> &profile) {
+	for (unsigned l=0; l<sizeof(kBusyWorkLengths)/sizeof(kBusyWorkLengths[0]); l++) {
+		unsigned long len = kBusyWorkLengths[l];
+		LatencyHistogram hist;
+		init_histogram(hist);
+		for (unsigned i=0; i<num_samples; i++) {
+			uint64_t start = now_ns();
+			busy_work(ns_to_ts(len));
+			uint64_t achieved = now_ns() - start;
+			histogram_record(hist, achieved*1000000/len);
+		}
+
+		ostringstream name;
+		name << "busy_work_" << len;
+		profile.push_back(make_overhead_entry(name.str(), "ppm", hist));
+	}
+}
+
+void measure_omp(unsigned num_samples, vector<OverheadEntry> &profile) {
+	unsigned num_procs = omp_get_num_procs();
+	omp_set_dynamic(0);
+	omp_set_nested(0);
+
+	// Team sizes 1, 2, 4, ... and the number of processors
+	vector<unsigned> team_sizes;
+	for (unsigned n=1; n<num_procs; n*=2) {
+		team_sizes.push_back(n);
+	}
+	team_sizes.push_back(num_procs);
+
+	const char *names[] = {"omp_static_", "omp_dynamic_"};
+	const omp_sched_t scheds[] = {omp_sched_static, omp_sched_dynamic};
+	for (unsigned s=0; s<2; s++) {
+		omp_set_schedule(scheds[s], 1);
+		for (unsigned t=0; t<team_sizes.size(); t++) {
+			unsigned n = team_sizes[t];
+			omp_set_num_threads(n);
+
+			LatencyHistogram hist;
+			init_histogram(hist);
+			// The first region creates the threads and is not measured
+			for (unsigned i=0; i<=num_samples; i++) {
+				uint64_t start = now_ns();
+				#pragma omp parallel for schedule(runtime)
+				for (unsigned j=0; j<n; j++) {
+					__asm__ __volatile__("" ::: "memory");
+				}
+				uint64_t duration = now_ns() - start;
+				if (i != 0) histogram_record(hist, duration);
+			}
+
+			ostringstream name;
+			name << names[s] << n;
+			profile.push_back(make_overhead_entry(name.str(), "ns", hist));
+		}
+	}
+}
+
+// Fork and exec this program as a task, as clustering_launcher does, and
+// measure until both processes have passed a barrier
+void measure_launch(unsigned num_samples, vector<OverheadEntry> &profile) {
+	LatencyHistogram hist;
+	init_histogram(hist);
+	for (unsigned i=0; i<num_samples; i++) {
+		ostringstream barrier_name;
+		barrier_name << "/RT_GOMP_OVERHEAD_BARRIER" << getpid() << "_" << i;
+		if (init_single_use_barrier(barrier_name.str().c_str(), 2) != 0) {
+			fprintf(stderr, "ERROR: Failed to initialize barrier\n");
+			return;
+		}
+
+		uint64_t start = now_ns();
+		pid_t pid = fork();
+		if (pid == 0) {
+			execl("/proc/self/exe", "overhead_bench", kBarrierChildArg, barrier_name.str().c_str(), (char*)NULL);
+			perror("Execv-ing a new task failed");
+			_exit(1);
+		} else if (pid < 0) {
+			perror("Forking a new process for task failed");
+			return;
+		}
+
+		await_single_use_barrier(barrier_name.str().c_str());
+		histogram_record(hist, now_ns() - start);
+		waitpid(pid, NULL, 0);
+	}
+	profile.push_back(make_overhead_entry("launch_to_barrier", "ns", hist));
+}
+
+void usage(const char *program) {
+	fprintf(stderr, "Usage: %s [-o profile_file] [-n num_samples] [-r]\n", program);
+}
+
+int main(int argc, char *argv[]) {
+	// A launched task only waits at the barrier
+	if (argc == 3 && strcmp(argv[1], kBarrierChildArg) == 0) {
+		return (await_single_use_barrier(argv[2]) == 0) ? 0 : 1;
+	}
+
+	string profile_file("overhead_profile.txt");
+	unsigned num_samples = 100000;
+	bool real_time = false;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "o:n:r")) != -1) {
+		switch (opt) {
+		case 'o':
+			profile_file = optarg;
+			break;
+		case 'n':
+			num_samples = atoi(optarg);
+			break;
+		case 'r':
+			real_time = true;
+			break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (num_samples < 100) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	if (real_time) {
+		sched_param sp;
+		sp.sched_priority = 97;
+		if (sched_setscheduler(getpid(), SCHED_FIFO, &sp) != 0) {
+			perror("ERROR: Could not set process scheduler/priority");
+			return 2;
+		}
+	}
+
+	vector<OverheadEntry> profile;
+	measure_get_time(num_samples, profile);
+	measure_sleep(num_samples/100, profile);
+	measure_busy_work(num_samples/100, profile);
+	measure_omp(num_samples/10, profile);
+	measure_launch(num_samples/100, profile);
+
+	for (unsigned i=0; i<profile.size(); i++) {
+		const OverheadEntry &entry = profile[i];
+		printf("%-20s %-4s mean %12.1f p50 %10.0f p99 %10.0f p99.9 %10.0f max %10.0f\n", entry.name.c_str(),
+			   entry.unit.c_str(), entry.mean, entry.p50, entry.p99, entry.p999, entry.max);
+	}
+
+	if (!write_overhead_profile(profile_file, profile)) {
+		fprintf(stderr, "ERROR: Cannot write the overhead profile to %s\n", profile_file.c_str());
+		return 2;
+	}
+	return 0;
+}
@@ -0,0 +1,655 @@
+// Core partitioning of task sets by federated scheduling (FS).
+// See partition.h for the allocation objectives.
+
+#include <iostream>
+#include <stdlib.h>
+#include <vector>
+#include <cmath>
+#include <map>
+#include <algorithm>
+#include "partition.h"
+#include "gedf_analysis.h"
+
+using namespace std;
+
+// Busy-work ratio measured for the longest length not above @len (or the shortest length)
+static double busy_work_ratio(const FsOverheads &overheads, unsigned long len) {
+	const vector<pair<unsigned long, double> > &ratios = overheads.busy_work_ratios;
+	if (ratios.empty()) return 1.0;
+
+	unsigned i = 0;
+	while (i+1 < ratios.size() && ratios[i+1].first <= len) {
+		i++;
+	}
+	return ratios[i].second;
+}
+
+void init_taskset(const vector<TaskSpec> &tasks, TaskSet &ts, const FsOverheads *overheads) {
+	ts.taskset.clear();
+	for (unsigned i=0; i<tasks.size(); i++) {
+		const TaskSpec &task_spec = tasks[i];
+
+		// Create a Task structure for this task
+		Task task;
+		task.id = task_spec.id;
+		task.work = task_spec.work;
+		task.span = task_spec.span;
+		task.period = task_spec.period;
+		task.deadline = task_spec.deadline;
+		task.release = task_spec.release;
+
+		if (overheads != 0) {
+			double work = overheads->release, span = overheads->release;
+			for (unsigned j=0; j<task_spec.segments.size(); j++) {
+				const SegmentSpec &segment = task_spec.segments[j];
+				double len = segment.len*busy_work_ratio(*overheads, segment.len);
+				work += segment.num_strands*len + overheads->fork_join;
+				span += len + overheads->fork_join;
+			}
+			task.work = ceil(work);
+			task.span = ceil(span);
+		}
+
+		task.required_cores = 0;
+		task.min_cores = 0;
+		task.pooled = false;
+		task.first_core = -1;
+		task.last_core = -1;
+
+		// Add this task to the task set
+		ts.taskset.insert(std::pair<unsigned, Task> (task.id, task));
+	}
+}
+
+bool fs_overheads_from_profile(const vector<OverheadEntry> &profile, unsigned max_cores, FsOverheads &overheads) {
+	const OverheadEntry *release = find_overhead_entry(profile, "sleep_until_ts");
+	if (release == NULL) return false;
+	overheads.release = release->p99;
+
+	unsigned team = 0;
+	overheads.fork_join = 0;
+	overheads.busy_work_ratios.clear();
+	for (unsigned i=0; i<profile.size(); i++) {
+		const OverheadEntry &entry = profile[i];
+		if (entry.name.compare(0, 10, "busy_work_") == 0) {
+			unsigned long len = strtoul(entry.name.c_str() + 10, NULL, 10);
+			overheads.busy_work_ratios.push_back(make_pair(len, max(entry.p99/1000000, 1.0)));
+		} else if (entry.name.compare(0, 12, "omp_dynamic_") == 0) {
+			unsigned n = atoi(entry.name.c_str() + 12);
+			if (n <= max_cores && n > team) {
+				team = n;
+				overheads.fork_join = entry.p99;
+			}
+		}
+	}
+	if (overheads.busy_work_ratios.empty() || team == 0) return false;
+
+	sort(overheads.busy_work_ratios.begin(), overheads.busy_work_ratios.end());
+	return true;
+}
+
+// Calculated the required number of cores for a task by federated scheduling
+unsigned fs_required_cores(Task task) {
+	unsigned long work = task.work;
+	unsigned long span = task.span;
+	unsigned long deadline = task.deadline;
+
+	unsigned cores = ceil(((float)(work - span))/(deadline - span));
+	return cores;
+}
+
+// Track the number of allocated cores for each task
+typedef struct Allocated {
+	unsigned id; // task id
+	unsigned allocated_cores; // already allocated cores for each task
+} Allocated;
+
+
+// Track the number of additional cores each task needs
+typedef struct Slack {
+	unsigned id; // id of the corresponding task
+	unsigned needed_cores; // the number of additional cores it needs
+} Slack;
+
+// Track the gap between n_i and (C_i-L_i)/(D_i-L_i) for the tasks
+typedef struct Gap {
+	unsigned id; // id of the corresponding task
+	float gap; // the gap of this task
+} Gap;
+
+
+// Function to sort tasks' slacks in decreasing order
+bool sort_slacks(Slack first, Slack second) {
+	return (first.needed_cores > second.needed_cores);
+}
+
+// Function to sort tasks' gap values in increasing order
+bool sort_gaps(Gap first, Gap second) {
+	return (first.gap < second.gap);
+}
+
+double normalized_response_bound(const Task &task, unsigned n) {
+	if (n == 0) return HUGE_VAL;
+	return (task.span + (double)(task.work - task.span)/n)/task.deadline;
+}
+
+bool parse_allocation_objective(const char *name, Allocation_Objective &objective) {
+	string s(name);
+	if (s == "greedy") objective = ALLOC_GREEDY;
+	else if (s == "response") objective = ALLOC_MAX_RESPONSE;
+	else if (s == "meeting") objective = ALLOC_TASKS_MEETING;
+	else if (s == "lost") objective = ALLOC_UTIL_LOST;
+	else if (s == "tardiness") objective = ALLOC_TARDINESS;
+	else return false;
+	return true;
+}
+
+// Share out the spare cores (on top of the minimum cores) greedily.
+// Tasks are served round-robin in decreasing order of the number of
+// additional cores they need, until they get their required cores.
+void greedy_allocation(TaskSet &ts, unsigned spare_cores, map<unsigned, unsigned> &allocated) {
+	map<unsigned, Task>::iterator it;
+
+	// Store the number of additional cores each task needs
+	vector<Slack> slacks;
+	
+	for (it = ts.taskset.begin(); it != ts.taskset.end(); it++) {
+		// Record the cores already allocated to each task
+		allocated[it->second.id] = it->second.min_cores;
+
+		Slack slack;
+		slack.id = it->second.id;
+		slack.needed_cores = it->second.required_cores - it->second.min_cores;
+		slacks.push_back(slack);
+	}
+
+	// Sort the tasks by decreasing number of additional needed cores
+	sort(slacks.begin(), slacks.end(), sort_slacks);
+	
+	// Distribute spare cores to the tasks
+	while (spare_cores > 0) {
+		for (unsigned i = 0; i<slacks.size(); i++) {
+			if (spare_cores <= 0) { 
+				// No more spare core, we're done
+				break;
+			}
+
+			unsigned task_id = slacks[i].id;
+			if (allocated[task_id] >= ts.taskset[task_id].required_cores) {
+				// This task is already allocated required cores, move on
+				continue;
+			}
+
+			// Otherwise, assign it 1 more core
+			slacks[i].needed_cores -= 1;
+			allocated[task_id] += 1;
+			spare_cores -= 1;
+		}
+	}
+}
+
+// Cost of an allocation w.r.t an objective. Costs are compared
+// lexicographically: first the objective, then the maximum normalized
+// response-time bound among the tasks to break ties.
+typedef struct Cost {
+	double objective;
+	double max_response;
+} Cost;
+
+bool operator<(const Cost &a, const Cost &b) {
+	if (a.objective != b.objective) return a.objective < b.objective;
+	return a.max_response < b.max_response;
+}
+
+// Cost of giving n cores to a task
+Cost task_cost(const Task &task, unsigned n, Allocation_Objective objective) {
+	Cost cost;
+	cost.max_response = normalized_response_bound(task, n);
+	switch (objective) {
+	case ALLOC_TASKS_MEETING:
+		cost.objective = (n >= task.required_cores) ? 0 : 1;
+		break;
+	case ALLOC_UTIL_LOST:
+		cost.objective = (n >= task.required_cores) ? 0 : (double)task.work/task.period;
+		break;
+	case ALLOC_TARDINESS:
+		cost.objective = max(0.0, cost.max_response - 1);
+		break;
+	default:
+		cost.objective = cost.max_response;
+	}
+	return cost;
+}
+
+// Cost of the allocation to a group of tasks combined with the cost of one more task
+Cost combine_costs(const Cost &a, const Cost &b, Allocation_Objective objective) {
+	Cost cost;
+	if (objective == ALLOC_MAX_RESPONSE) {
+		cost.objective = max(a.objective, b.objective);
+	} else {
+		cost.objective = a.objective + b.objective;
+	}
+	cost.max_response = max(a.max_response, b.max_response);
+	return cost;
+}
+
+// Share out the cores optimally w.r.t the objective.
+// Each task gets between its minimum cores and its required cores.
+// Dynamic programming over the tasks: best[c] is the best cost of the tasks
+// considered so far using c cores in total, and choice[i][c] is the number of
+// cores given to task i in that allocation. This takes O(n * m * m) time.
+void exact_allocation(TaskSet &ts, unsigned num_cores, Allocation_Objective objective,
+					  map<unsigned, unsigned> &allocated) {
+	vector<const Task*> tasks;
+	map<unsigned, Task>::iterator it;
+	for (it = ts.taskset.begin(); it != ts.taskset.end(); it++) {
+		tasks.push_back(&it->second);
+	}
+
+	unsigned num_tasks = tasks.size();
+	const Cost zero = {0, 0};
+	vector<Cost> best(num_cores+1, zero), next_best(num_cores+1);
+	vector<bool> reachable(num_cores+1, false), next_reachable(num_cores+1);
+	vector<vector<unsigned> > choice(num_tasks, vector<unsigned>(num_cores+1, 0));
+	reachable[0] = true;
+
+	// Cost of each possible number of cores for the current task
+	vector<Cost> costs(num_cores+1);
+	for (unsigned i=0; i<num_tasks; i++) {
+		const Task &task = *tasks[i];
+		unsigned low = task.min_cores;
+		unsigned high = max(low, min(task.required_cores, num_cores));
+		for (unsigned k=low; k<=high && k<=num_cores; k++) {
+			costs[k] = task_cost(task, k, objective);
+		}
+
+		fill(next_reachable.begin(), next_reachable.end(), false);
+		for (unsigned c=0; c<=num_cores; c++) {
+			if (!reachable[c]) continue;
+			for (unsigned k=low; k<=high && c+k<=num_cores; k++) {
+				Cost cost = combine_costs(best[c], costs[k], objective);
+				if (!next_reachable[c+k] || cost < next_best[c+k]) {
+					next_best[c+k] = cost;
+					next_reachable[c+k] = true;
+					choice[i][c+k] = k;
+				}
+			}
+		}
+		best.swap(next_best);
+		reachable.swap(next_reachable);
+	}
+
+	// Pick the best allocation that fits in the system.
+	// There is one since the minimum cores of all tasks fit.
+	int used = -1;
+	for (unsigned c=0; c<=num_cores; c++) {
+		if (reachable[c] && (used < 0 || best[c] < best[used])) used = c;
+	}
+
+	vector<unsigned> cores(num_tasks);
+	unsigned c = used;
+	for (unsigned i=num_tasks; i>0; i--) {
+		cores[i-1] = choice[i-1][c];
+		c -= cores[i-1];
+	}
+
+	// Cores left over do not make the objective worse, so give them
+	// one at a time to the task with the largest response-time bound
+	// among those that did not get their required cores.
+	unsigned spare_cores = num_cores - used;
+	while (spare_cores > 0) {
+		int worst = -1;
+		for (unsigned i=0; i<num_tasks; i++) {
+			if (cores[i] >= tasks[i]->required_cores) continue;
+			if (worst < 0 || normalized_response_bound(*tasks[i], cores[i]) >
+				normalized_response_bound(*tasks[worst], cores[worst])) {
+				worst = i;
+			}
+		}
+		if (worst < 0) break;
+		cores[worst]++;
+		spare_cores--;
+	}
+
+	for (unsigned i=0; i<num_tasks; i++) {
+		allocated[tasks[i]->id] = cores[i];
+	}
+}
+
+// This function does the core partitioning for the task set
+void partition(TaskSet &ts, unsigned num_cores, Allocation_Objective objective) {
+
+	// Calculate the total number of cores required by federated scheduling
+	unsigned total_cores = 0;
+	map<unsigned, Task>::iterator it;
+	for (it = ts.taskset.begin(); it != ts.taskset.end(); it++) {
+		it->second.required_cores = fs_required_cores(it->second);
+		total_cores += it->second.required_cores;
+	}
+	
+	ts.total_required_cores = total_cores;
+
+	// Enough (or more) cores to allocate by FS.
+	if (ts.total_required_cores <= num_cores) {
+		ts.status = PARTITION_FOUND;
+		
+		/*
+		unsigned next_core = 0;
+		map<unsigned, Task>::iterator it;
+		for (it = ts.taskset.begin(); it != ts.taskset.end(); it++) {
+			unsigned required_cores = it->second.required_cores;
+			it->second.first_core = next_core;
+			it->second.last_core = next_core + required_cores - 1;
+			next_core = next_core + required_cores;
+		}
+
+		return;
+		*/
+
+		// Assign the spare cores to the tasks.
+		// Sort the tasks in increasing order of gap between its n_i and (C_i-L_i)/(D_i-L_i).
+		// Then assigning the spare cores in that order. For example, task with 
+		// a gap of 0.1 is preferred to receive a core than task with a gap of 0.9.
+		
+		// A vector of the gaps for the tasks
+		vector<Gap> gaps;
+		
+		for (it = ts.taskset.begin(); it != ts.taskset.end(); it++) {
+			Task &task = it->second;
+			unsigned n_i = task.required_cores;
+			float ratio = (float)(task.work - task.span)/(task.deadline - task.span);
+			Gap gap;
+			gap.id = it->first;
+			gap.gap = (float)n_i - ratio;
+			gaps.push_back(gap);
+		}
+
+		// Sort the tasks in increasing order of their gaps
+		sort(gaps.begin(), gaps.end(), sort_gaps);
+
+		// The number of spare cores
+		unsigned spare_cores = num_cores - ts.total_required_cores;
+
+		// Store the number of cores allocated to each tasks
+		map<unsigned, unsigned> allocated_cores;
+		for (it = ts.taskset.begin(); it != ts.taskset.end(); it++) {
+			unsigned task_id = it->first;
+			allocated_cores[task_id] = it->second.required_cores;
+		}
+
+		// Go through the list of task in increasing order and 
+		// assign core one-by-one.
+		unsigned num_tasks = ts.taskset.size();
+		unsigned idx = 0;
+		while (spare_cores > 0) {
+			unsigned task_id = gaps[idx % num_tasks].id;
+			allocated_cores[task_id] += 1;
+			idx++;
+			spare_cores--;
+		}
+
+		// Now set the first core and last core for each task
+		unsigned next_core = 0;
+		for (it = ts.taskset.begin(); it != ts.taskset.end(); it++) {
+			unsigned id = it->second.id;
+			unsigned assigned_cores = allocated_cores[id];
+			it->second.first_core = next_core;
+			it->second.last_core = next_core + assigned_cores - 1;
+			next_core += assigned_cores;
+		}
+		
+		return;
+	}
+
+	// If there are not enough cores to allocate by FS
+	// Calculate the total number of minimum cores for all tasks
+	unsigned total_min_cores = 0;
+	for (it = ts.taskset.begin(); it != ts.taskset.end(); it++) {
+		unsigned long work = it->second.work;
+		unsigned long period = it->second.deadline; // assuming implicit deadline task set
+		it->second.min_cores = floor((float)work/period); // take floor of the task's utilization
+
+		total_min_cores += it->second.min_cores;
+	}
+
+	if (total_min_cores <= num_cores) {
+		// There are enough or more cores than the total minimum cores of all tasks
+		ts.status = HEURISTIC_USED;
+
+		// Track the number of cores allocated to each task 
+		// key: task id. value: number of cores
+		map<unsigned, unsigned> allocated;
+
+		if (objective == ALLOC_GREEDY) {
+			greedy_allocation(ts, num_cores - total_min_cores, allocated);
+		} else {
+			exact_allocation(ts, num_cores, objective, allocated);
+		}
+
+		// Now write the allocation to the tasks
+		unsigned next_core = 0;
+		for (it = ts.taskset.begin(); it != ts.taskset.end(); it++) {
+			unsigned id = it->first;
+			unsigned alloc_cores = allocated[id];
+			it->second.first_core = next_core;
+			it->second.last_core = next_core + alloc_cores - 1;
+			next_core += alloc_cores;
+		}
+		return;
+
+	} else {
+		// Not enough cores even for minimum cores for each task.
+		// Since the minimum core for each task is basically equal to 
+		// its utilization (more exactly, less than or equal to), 
+		// this case means the total utilization of the task set is 
+		// larger than the number of cores in the system.
+		// So we just return and ignore this task set and replace with another.
+		ts.status = INVALID;
+		cerr << "ERROR: Task set is too big to run on the system!!!" << endl;
+		return;
+	}
+}
+
+// Timing parameters of a pooled task for the GEDF analysis
+static DagTask to_dag_task(const Task &task) {
+	DagTask dag_task;
+	dag_task.work = task.work;
+	dag_task.span = task.span;
+	dag_task.period = task.period;
+	dag_task.deadline = task.deadline;
+	return dag_task;
+}
+
+// Find a hybrid partition on @num_cores cores, with the required cores of the
+// tasks already computed. Return false, leaving the task set untouched, if
+// no pool passes the GEDF test.
+static bool hybrid_allocation(TaskSet &ts, unsigned num_cores) {
+	map<unsigned, bool> pooled;
+	unsigned dedicated_cores = 0;
+	map<unsigned, Task>::iterator it;
+	for (it = ts.taskset.begin(); it != ts.taskset.end(); it++) {
+		const Task &task = it->second;
+		pooled[task.id] = (task.work <= task.deadline);
+		if (!pooled[task.id]) dedicated_cores += task.required_cores;
+	}
+
+	while (true) {
+		if (dedicated_cores < num_cores) {
+			vector<DagTask> pool;
+			for (it = ts.taskset.begin(); it != ts.taskset.end(); it++) {
+				if (pooled[it->first]) pool.push_back(to_dag_task(it->second));
+			}
+			if (gedf_response_time_test(pool, num_cores - dedicated_cores)) break;
+		}
+
+		// Move the heavy task that wastes the most of its cores to the pool
+		int worst = -1;
+		double worst_waste = 0;
+		for (it = ts.taskset.begin(); it != ts.taskset.end(); it++) {
+			const Task &task = it->second;
+			if (pooled[task.id]) continue;
+			double waste = task.required_cores - (double)task.work/task.period;
+			if (worst < 0 || waste > worst_waste) {
+				worst = task.id;
+				worst_waste = waste;
+			}
+		}
+		if (worst < 0) return false;
+		pooled[worst] = true;
+		dedicated_cores -= ts.taskset[worst].required_cores;
+	}
+
+	// The dedicated clusters come first, in the order of the task ids, and
+	// the pool takes the remaining cores
+	ts.status = PARTITION_HYBRID;
+	unsigned next_core = 0;
+	for (it = ts.taskset.begin(); it != ts.taskset.end(); it++) {
+		Task &task = it->second;
+		task.pooled = pooled[task.id];
+		if (task.pooled) continue;
+		task.first_core = next_core;
+		task.last_core = next_core + task.required_cores - 1;
+		next_core += task.required_cores;
+	}
+	for (it = ts.taskset.begin(); it != ts.taskset.end(); it++) {
+		if (!it->second.pooled) continue;
+		it->second.first_core = next_core;
+		it->second.last_core = num_cores - 1;
+	}
+	return true;
+}
+
+void partition_hybrid(TaskSet &ts, unsigned num_cores, Allocation_Objective objective) {
+	partition(ts, num_cores, objective);
+	if (ts.status != PARTITION_FOUND) {
+		hybrid_allocation(ts, num_cores);
+	}
+}
+
+
+// Free CPUs of @topology (by index) in the LLC domain or node @domain of
+// @level (0: LLC, 1: node, 2: the whole machine)
+static vector<unsigned> free_cpus(const Topology &topology, const vector<bool> &used, unsigned level, unsigned domain) {
+	vector<unsigned> cpus;
+	for (unsigned i=0; i<topology.cpus.size(); i++) {
+		const CpuTopology &cpu = topology.cpus[i];
+		if (used[i]) continue;
+		if ((level == 0 && cpu.llc != domain) || (level == 1 && cpu.node != domain)) continue;
+		cpus.push_back(i);
+	}
+	return cpus;
+}
+
+// Take @n of the free CPUs @candidates (indexes in @topology) for a cluster:
+// the odd part of the cluster from the siblings of partly used cores first,
+// then whole cores, then any CPU in order.
+static void take_cpus(const Topology &topology, const vector<unsigned> &candidates, unsigned n,
+					  vector<bool> &used, vector<unsigned> &cluster) {
+	// Number of CPUs of each core
+	map<unsigned, unsigned> core_size;
+	unsigned smt = 1;
+	for (unsigned i=0; i<topology.cpus.size(); i++) {
+		smt = max(smt, ++core_size[topology.cpus[i].core]);
+	}
+
+	// Group the candidates by core, in the order of their lowest CPU
+	vector<vector<unsigned> > cores;
+	map<unsigned, unsigned> core_index;
+	for (unsigned k=0; k<candidates.size(); k++) {
+		unsigned core = topology.cpus[candidates[k]].core;
+		if (core_index.count(core) == 0) {
+			core_index[core] = cores.size();
+			cores.push_back(vector<unsigned>());
+		}
+		cores[core_index[core]].push_back(candidates[k]);
+	}
+
+	vector<bool> whole(cores.size());
+	for (unsigned g=0; g<cores.size(); g++) {
+		whole[g] = (cores[g].size() == core_size[topology.cpus[cores[g][0]].core]);
+	}
+
+	unsigned odd = n % smt;
+	for (unsigned pass=0; pass<3; pass++) {
+		for (unsigned g=0; g<cores.size() && n > 0; g++) {
+			unsigned count = min(n, (unsigned)cores[g].size());
+			if (pass == 0) {
+				if (whole[g] || odd == 0) continue;
+				count = min(count, odd);
+				odd -= count;
+			} else if (pass == 1 && (!whole[g] || cores[g].size() > n)) {
+				continue;
+			}
+
+			for (unsigned k=0; k<count; k++) {
+				used[cores[g][k]] = true;
+				cluster.push_back(topology.cpus[cores[g][k]].cpu);
+			}
+			cores[g].erase(cores[g].begin(), cores[g].begin() + count);
+			n -= count;
+		}
+	}
+}
+
+bool place_clusters(TaskSet &ts, const Topology &topology) {
+	// Largest clusters first, in the order of the task ids for equal sizes.
+	// The first pooled task stands for the EDF pool.
+	vector<pair<unsigned, unsigned> > clusters;
+	map<unsigned, Task>::iterator it;
+	unsigned total = 0;
+	int pool_id = -1;
+	for (it = ts.taskset.begin(); it != ts.taskset.end(); it++) {
+		it->second.cpus.clear();
+		if (it->second.first_core < 0) continue;
+		if (it->second.pooled) {
+			if (pool_id >= 0) continue;
+			pool_id = it->first;
+		}
+		// A task starved of cores by a heuristic partition keeps its empty
+		// core range, with no CPU
+		if (it->second.last_core < it->second.first_core) continue;
+		unsigned size = it->second.last_core - it->second.first_core + 1;
+		clusters.push_back(make_pair(size, it->first));
+		total += size;
+	}
+	if (total > topology.cpus.size()) {
+		return false;
+	}
+	stable_sort(clusters.begin(), clusters.end(),
+		[](const pair<unsigned, unsigned> &a, const pair<unsigned, unsigned> &b) { return a.first > b.first; });
+
+	vector<bool> used(topology.cpus.size(), false);
+	for (unsigned c=0; c<clusters.size(); c++) {
+		unsigned n = clusters[c].first;
+
+		// The LLC domain, or else the node, with the fewest free CPUs that
+		// can hold the cluster, or else the whole machine
+		vector<unsigned> candidates;
+		for (unsigned level=0; level<3 && candidates.empty(); level++) {
+			for (unsigned i=0; i<topology.cpus.size(); i++) {
+				unsigned domain = (level == 0) ? topology.cpus[i].llc : topology.cpus[i].node;
+				vector<unsigned> cpus = free_cpus(topology, used, level, domain);
+				if (cpus.size() >= n && (candidates.empty() || cpus.size() < candidates.size())) {
+					candidates = cpus;
+				}
+			}
+		}
+
+		Task &task = ts.taskset[clusters[c].second];
+		take_cpus(topology, candidates, n, used, task.cpus);
+		sort(task.cpus.begin(), task.cpus.end());
+		task.first_core = task.cpus.front();
+		task.last_core = task.cpus.back();
+	}
+
+	if (pool_id >= 0) {
+		const Task &pool = ts.taskset[pool_id];
+		for (it = ts.taskset.begin(); it != ts.taskset.end(); it++) {
+			if (!it->second.pooled) continue;
+			it->second.cpus = pool.cpus;
+			it->second.first_core = pool.first_core;
+			it->second.last_core = pool.last_core;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,132 @@
+// Core partitioning of task sets by federated scheduling (FS).
+// A task set is partitioned by giving each task a number of dedicated cores.
+// When the system does not have enough cores for all tasks, the available
+// cores are shared out so as to optimize a selectable objective. The clusters
+// are then placed on the machine's CPUs according to its topology.
+//
+// In the hybrid (semi-federated) mode, the tasks that FS cannot all give
+// their required cores share the cores left over by the heavy tasks, as a
+// pool scheduled by global EDF (see common/edf_pool.h), instead of being
+// starved of cores.
+
+#ifndef PARTITION_H
+#define PARTITION_H
+
+#include <map>
+#include <vector>
+#include "taskset_io.h"
+#include "overhead_profile.h"
+#include "topology.h"
+
+// Whether we find a FS-valid core partition for task set or not.
+enum Partition_Status {
+	PARTITION_FOUND = 0, // enough cores to allocate by FS
+	HEURISTIC_USED = 1, // must use some heuristics to allocate cores to tasks
+	INVALID = 2, // there is no valid partition found for this task set
+	PARTITION_HYBRID = 3 // heavy tasks get dedicated cores, the other tasks share an EDF pool
+};
+
+
+// Objective used to share out the cores when there are not enough of them
+// for every task to get the number of cores required by FS.
+// Except for ALLOC_GREEDY, the allocation is optimal for the objective.
+enum Allocation_Objective {
+	ALLOC_GREEDY = 0, // hand out spare cores in decreasing order of needed cores
+	ALLOC_MAX_RESPONSE = 1, // minimize the maximum normalized response-time bound
+	ALLOC_TASKS_MEETING = 2, // maximize the number of tasks that get their required cores
+	ALLOC_UTIL_LOST = 3, // minimize the total utilization of tasks that do not get their required cores
+	ALLOC_TARDINESS = 4 // minimize the total normalized tardiness bound
+};
+
+// Structure contains information for each task.
+// All timing information is in nanoseconds.
+// For core allocation, negative values mean the task is not allocated cores yet.
+typedef struct Task {
+	unsigned id; // id of the task
+	unsigned long work;
+	unsigned long span;
+	unsigned long period;
+	unsigned long deadline;
+	unsigned long release;
+	unsigned required_cores; // number of required cores by federated scheduling
+	int first_core; // first core currently assigned to the task
+	int last_core;  // last core currently assigned to the task
+	std::vector<unsigned> cpus; // CPUs of the task's cluster, set by place_clusters
+	unsigned min_cores; // minimum number of cores can be possibly assigned to this task, floor(C/T)
+	bool pooled; // runs in the shared EDF pool of a hybrid partition, whose cores are its cores
+} Task;
+
+
+// Measured overheads of the FS runtime, used to inflate the tasks' work and span
+typedef struct FsOverheads {
+	double release; // delay from the release of a job to its start (ns)
+	double fork_join; // overhead of a segment's parallel region (ns)
+	// Achieved over requested length of strands, by increasing requested length (ns)
+	std::vector<std::pair<unsigned long, double> > busy_work_ratios;
+} FsOverheads;
+
+
+// Information for the task set is stored here
+typedef struct TaskSet {
+	enum Partition_Status status;
+	unsigned total_required_cores; // total number of cores required by FS
+	std::map<unsigned, Task> taskset; // A map from task id to its structure
+} TaskSet;
+
+
+// Fill a TaskSet with the tasks read from a task set file.
+// With @overheads, the work and span are computed from the segments with
+// each strand stretched by the busy-work ratio measured for the closest
+// shorter length, plus the release delay and one fork/join overhead per segment.
+void init_taskset(const std::vector<TaskSpec> &tasks, TaskSet &ts, const FsOverheads *overheads = 0);
+
+// Take the FS overheads from a profile written by overhead_bench: the 99th
+// percentiles of the release delay, of the busy-work ratios, and of the
+// fork/join overhead of the dynamic schedule for the largest measured team of
+// at most @max_cores threads. Return false if the profile lacks an entry.
+// Ratios below 1 are raised to 1.
+bool fs_overheads_from_profile(const std::vector<OverheadEntry> &profile, unsigned max_cores, FsOverheads &overheads);
+
+// Calculated the required number of cores for a task by federated scheduling
+unsigned fs_required_cores(Task task);
+
+// Response-time bound of a task running alone on n cores, normalized by its deadline.
+// It is Graham's bound for a DAG: (L + (C-L)/n)/D.
+double normalized_response_bound(const Task &task, unsigned n);
+
+// Parse the name of an allocation objective. Return false if it is unknown.
+bool parse_allocation_objective(const char *name, Allocation_Objective &objective);
+
+// This function does the core partitioning for the task set on @num_cores
+// cores. The tasks get consecutive core indexes from 0, in the order of their ids.
+void partition(TaskSet &ts, unsigned num_cores, Allocation_Objective objective = ALLOC_MAX_RESPONSE);
+
+// Partition like partition(), but when FS needs more cores than @num_cores,
+// try a hybrid partition first. The heavy tasks (C > D) get their required
+// cores and the light ones go to a pool of the remaining cores, which must
+// pass the GEDF response-time test. While it does not, the heavy task that
+// wastes the most of its cores, n_i - C_i/T_i, is moved to the pool. If no
+// pool passes, the task set is partitioned by @objective as by partition().
+// A heavy task runs either on its dedicated cluster or in the pool, never
+// on both: semi-federated scheduling would give it floor(n_i) dedicated
+// cores and its leftover demand in the pool, but a job's OpenMP team runs on
+// a single cluster in the FS runtime, which has no way to run a segment on
+// dedicated and pooled threads at once. The fractional core lost to the
+// ceiling of a heavy task is thus recovered only by moving it to the pool.
+void partition_hybrid(TaskSet &ts, unsigned num_cores, Allocation_Objective objective = ALLOC_MAX_RESPONSE);
+
+// Place the clusters of a partitioned task set on the CPUs of @topology,
+// which must have as many CPUs as the cores of the partition, and set the
+// tasks' CPUs (and their first and last cores to the lowest and highest).
+// The largest clusters are placed first, each in the LLC domain, or else the
+// NUMA node, with the fewest free CPUs that can hold it, so that a cluster
+// straddles LLCs or nodes only if no single one has enough free CPUs. Within
+// it, a cluster takes whole physical cores, so that the SMT siblings of a
+// core are split between clusters only for clusters of an odd size.
+// The EDF pool is placed as a single cluster shared by the pooled tasks.
+// A task given no core (last core before its first) gets no CPU and keeps
+// its core range.
+// Return false if the topology does not have enough CPUs.
+bool place_clusters(TaskSet &ts, const Topology &topology);
+
+#endif // PARTITION_H
@@ -2,17 +2,14 @@
 
 PROC_NUM=16
 TOTAL_UTIL=0.75
+MACHINE_CORES=$(nproc)
 
 for NUM_TASKS in 5
 do
 	path='../data/core='${PROC_NUM}'n='${NUM_TASKS}'util='${TOTAL_UTIL}'lost=0.3125'
-	for i in {1..100}
-	do
-		rtps_file=${path}'/taskset'${i}
-	
-		./clustering_launcher_fs ${rtps_file}
-		sleep 2s
-	done
+	# Run the 100 task sets on as many disjoint clusters of PROC_NUM cores
+	# as the machine has; the exit status of each run goes to the summary file
+	./campaign -m ${MACHINE_CORES} -o ${path}'/campaign_summary.txt' ${path}
 done
 
-echo "FEDERATED SCHEDULING cluster finished!"
\ No newline at end of file
+echo "FEDERATED SCHEDULING cluster finished!"
@@ -1,14 +1,10 @@
 #!/bin/bash
 
-PROC_NUM=16
-TOTAL_UTIL=0.75
-NUM_TASKS=5
-
-path='../data/core='${PROC_NUM}'n='${NUM_TASKS}'util='${TOTAL_UTIL}'lost=0.3125'
-for i in {1..100}
-do
-	file=${path}'/taskset'${i}'.rtpt'
-	./partition ${file}
-done
+# The folder of the task sets is the first argument, for example
+# ../data/core=16n=5util=0.75lost=0.3125 (see gen_util_lost.sh)
+path=${1:-'../data/core=16n=5util=0.75lost=0.3125'}
+# Partition all task sets in the folder at once. The counts of each
+# partition status are written to partition_summary.txt in the folder.
+./partition ${path}
 
 echo "Finished!"
\ No newline at end of file
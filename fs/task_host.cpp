@@ -0,0 +1,235 @@
+// Run FS task sets with all the tasks of a task set hosted as threads of a
+// single process, instead of one process per task forked and execv-ed by
+// clustering_launcher. Several task sets are run back to back, so the program
+// is loaded once per experiment rather than once per task.
+//
+// Each task runs task_manager_main in its own thread with the arguments that
+// clustering_launcher would pass to the task process, and writes to the same
+// output files (<base>_output/task<t>.txt and the files of task_env.h). Since
+// the tasks share the process, all of them must be synthetic tasks.
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "single_use_barrier.h"
+#include "taskset_io.h"
+#include "task_env.h"
+#include "edf_pool.h"
+#include "core_lending.h"
+
+enum rt_gomp_task_host_error_codes
+{
+	RT_GOMP_TASK_HOST_SUCCESS,
+	RT_GOMP_TASK_HOST_FILE_OPEN_ERROR,
+	RT_GOMP_TASK_HOST_FILE_PARSE_ERROR,
+	RT_GOMP_TASK_HOST_BARRIER_INITIALIZATION_ERROR,
+	RT_GOMP_TASK_HOST_THREAD_ERROR,
+	RT_GOMP_TASK_HOST_ARGUMENT_ERROR
+};
+
+// Defined by task_manager.cpp when built with RT_GOMP_TASK_HOST
+extern int task_manager_main(int argc, char *argv[], FILE *output);
+
+// The program all the hosted tasks must run
+const std::string kHostedProgram = "synthetic_task";
+
+// A task hosted in a thread
+typedef struct {
+	std::vector<std::string> args;
+	std::vector<char*> argv;
+	TaskEnv env;
+	FILE *output;
+	pthread_t thread;
+	int ret_val;
+} HostedTask;
+
+static void *run_hosted_task(void *arg) {
+	HostedTask *task = (HostedTask*) arg;
+	set_thread_task_env(&task->env);
+	task->ret_val = task_manager_main(task->argv.size()-1, &task->argv[0], task->output);
+	set_thread_task_env(NULL);
+	return NULL;
+}
+
+// Build the arguments of task_manager_main for a task, as clustering_launcher does
+static void task_manager_args(const TaskSpec &task, const std::string &barrier_name,
+							  std::vector<std::string> &args) {
+	args.push_back(task.program_name);
+
+	// The task's CPU list stands for its first core
+	std::ostringstream partition;
+	partition << format_cpu_list(task.cpus) << " " << task.last_core << " " << task.priority;
+	std::istringstream partition_stream(partition.str());
+	std::string partition_param;
+	while (partition_stream >> partition_param) {
+		args.push_back(partition_param);
+	}
+
+	// Skip the work and span, which were only needed by the scheduler
+	std::istringstream timing_stream(task.timing_line);
+	std::string timing_param;
+	for (unsigned i = 0; i < 4; ++i) {
+		timing_stream >> timing_param;
+	}
+	while (timing_stream >> timing_param) {
+		args.push_back(timing_param);
+	}
+	args.push_back(barrier_name);
+
+	std::istringstream command_stream(task.command_line);
+	std::string task_arg;
+	while (command_stream >> task_arg) {
+		args.push_back(task_arg);
+	}
+}
+
+// Run the task set of @base.rtps. Return 0 on success, or an error code.
+static int run_taskset(const std::string &base, const std::string &barrier_name,
+					   const std::string &edf_pool_name, const std::string &lending_board_name) {
+	TaskSetSpec ts;
+	if (!read_rtps(base + ".rtps", ts)) {
+		return RT_GOMP_TASK_HOST_FILE_PARSE_ERROR;
+	}
+
+	if (ts.status == 0) {
+		fprintf(stderr, "Taskset is schedulable with FS: %s\n", base.c_str());
+	} else if (ts.status == 1) {
+		fprintf(stderr, "WARNING: Taskset may not be schedulable with FS: %s\n", base.c_str());
+	} else if (ts.status == 3) {
+		fprintf(stderr, "Taskset is schedulable with FS and a shared EDF pool: %s\n", base.c_str());
+	} else {
+		fprintf(stderr, "WARNING: Taskset NOT schedulable with FS: %s\n", base.c_str());
+		return RT_GOMP_TASK_HOST_SUCCESS;
+	}
+
+	unsigned num_tasks = ts.tasks.size();
+	for (unsigned i = 0; i < num_tasks; ++i) {
+		if (ts.tasks[i].program_name != kHostedProgram) {
+			fprintf(stderr, "ERROR: Task %u runs %s, only %s can be hosted\n", ts.tasks[i].id,
+					ts.tasks[i].program_name.c_str(), kHostedProgram.c_str());
+			return RT_GOMP_TASK_HOST_FILE_PARSE_ERROR;
+		}
+	}
+
+	// The tasks of the EDF pool of a hybrid partition share a table of their
+	// jobs' deadlines. They are threads of this process, so OMP_WAIT_POLICY
+	// cannot be made passive for them alone.
+	EdfPool *edf_pool = NULL;
+	for (unsigned i = 0; i < num_tasks && edf_pool == NULL; ++i) {
+		if (ts.tasks[i].edf_pool) {
+			edf_pool = create_edf_pool(edf_pool_name.c_str());
+			if (edf_pool == NULL) {
+				perror("ERROR: Creating the EDF pool failed");
+				return RT_GOMP_TASK_HOST_BARRIER_INITIALIZATION_ERROR;
+			}
+		}
+	}
+
+	// With RT_GOMP_RECLAIM=1, the tasks with dedicated cores lend and borrow
+	// idle CPUs on a shared board (see core_lending.h)
+	LendingBoard *lending_board = NULL;
+	const char *reclaim = getenv("RT_GOMP_RECLAIM");
+	if (reclaim != NULL && std::string(reclaim) == "1") {
+		lending_board = create_lending_board(lending_board_name.c_str());
+		if (lending_board == NULL) {
+			perror("WARNING: Creating the lending board failed, reclaiming disabled");
+		}
+	}
+
+	if (init_single_use_barrier(barrier_name.c_str(), num_tasks) != 0) {
+		fprintf(stderr, "ERROR: Failed to initialize barrier\n");
+		return RT_GOMP_TASK_HOST_BARRIER_INITIALIZATION_ERROR;
+	}
+
+	std::string out_folder = base + "_output";
+	std::vector<HostedTask> hosted(num_tasks);
+	for (unsigned i = 0; i < num_tasks; ++i) {
+		HostedTask &task = hosted[i];
+		unsigned t = ts.tasks[i].id;
+		task_manager_args(ts.tasks[i], barrier_name, task.args);
+		for (unsigned j = 0; j < task.args.size(); ++j) {
+			task.argv.push_back(const_cast<char*>(task.args[j].c_str()));
+		}
+		task.argv.push_back(NULL);
+
+		std::ostringstream log_file;
+		log_file << out_folder << "/task" << t << ".txt";
+		task.output = fopen(log_file.str().c_str(), "w");
+		if (task.output == NULL) {
+			perror("Opening the task output file failed");
+			return RT_GOMP_TASK_HOST_FILE_OPEN_ERROR;
+		}
+		task_output_env(out_folder, t, "", task.env);
+		if (ts.tasks[i].edf_pool) {
+			task.env["RT_GOMP_EDF_POOL"] = edf_pool_name;
+		} else if (lending_board != NULL) {
+			task.env["RT_GOMP_LENDING_BOARD"] = lending_board_name;
+		}
+	}
+
+	// The tasks wait for each other at the barrier, so they all have to be started
+	for (unsigned i = 0; i < num_tasks; ++i) {
+		fprintf(stderr, "Starting task %u\n", ts.tasks[i].id);
+		if (pthread_create(&hosted[i].thread, NULL, run_hosted_task, &hosted[i]) != 0) {
+			perror("Creating a thread for task failed");
+			exit(RT_GOMP_TASK_HOST_THREAD_ERROR);
+		}
+	}
+
+	fprintf(stderr, "All tasks started\n");
+
+	for (unsigned i = 0; i < num_tasks; ++i) {
+		pthread_join(hosted[i].thread, NULL);
+		fclose(hosted[i].output);
+		printf("Task %u. Exit status: %d\n", ts.tasks[i].id, hosted[i].ret_val);
+	}
+
+	if (edf_pool != NULL) {
+		close_edf_pool(edf_pool, edf_pool_name.c_str());
+	}
+	if (lending_board != NULL) {
+		close_lending_board(lending_board, lending_board_name.c_str());
+	}
+
+	fprintf(stderr, "All tasks finished\n");
+	return RT_GOMP_TASK_HOST_SUCCESS;
+}
+
+// Program usage:
+// ./task_host [-c cluster_id] path_to_rtps_wo_extension...
+// For example: ./task_host tasksets/taskset1 tasksets/taskset2
+// runs taskset1.rtps then taskset2.rtps in folder tasksets, and stores their
+// outputs to folders tasksets/taskset1_output and tasksets/taskset2_output.
+// The cluster id has the same use as for clustering_launcher.
+int main(int argc, char *argv[])
+{
+	std::string barrier_name = "/RT_GOMP_CLUSTERING_BARRIER";
+	std::string edf_pool_name = "/RT_GOMP_EDF_POOL";
+	std::string lending_board_name = "/RT_GOMP_LENDING_BOARD";
+
+	int first_taskset = 1;
+	if (argc > 2 && std::string(argv[1]) == "-c") {
+		barrier_name += argv[2];
+		edf_pool_name += argv[2];
+		lending_board_name += argv[2];
+		first_taskset = 3;
+	}
+
+	if (first_taskset >= argc) {
+		fprintf(stderr, "Usage: %s [-c cluster_number] path_to_rtps_wo_extension...\n", argv[0]);
+		return RT_GOMP_TASK_HOST_ARGUMENT_ERROR;
+	}
+
+	for (int i = first_taskset; i < argc; ++i) {
+		int ret_val = run_taskset(argv[i], barrier_name, edf_pool_name, lending_board_name);
+		if (ret_val != RT_GOMP_TASK_HOST_SUCCESS) {
+			return ret_val;
+		}
+	}
+
+	return RT_GOMP_TASK_HOST_SUCCESS;
+}
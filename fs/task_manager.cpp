@@ -4,6 +4,7 @@
 #include <stdint.h> //For uint64_t
 #include <inttypes.h> //For PRIu64
 #include <stdlib.h> //For malloc
+#include <string.h> //For memcpy
 #include <sched.h>
 #include <unistd.h> 
 #include <stdio.h>
@@ -14,9 +15,18 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <vector>
+#include <algorithm>
 #include "task.h"
 #include "timespec_functions.h"
+#include "job_record.h"
+#include "perf_counters.h"
+#include "edf_pool.h"
+#include "core_lending.h"
+#include "latency_histogram.h"
 #include "single_use_barrier.h"
+#include "task_env.h"
+#include "taskset_io.h"
 
 
 //There are one trillion nanoseconds in a second, or one with nine zeroes
@@ -36,10 +46,11 @@ enum rt_gomp_task_manager_error_codes
 };
 
 
-// Task parameters
-int priority;
-unsigned first_core, last_core;
-timespec period, deadline, relative_release;
+// Task parameters, one copy per thread since task_host runs each task
+// of a task set in its own thread
+__thread int priority;
+__thread unsigned last_core;
+__thread timespec period, deadline, relative_release;
 
 // Return time in nanosecond
 unsigned long long timespec2ns(timespec ts) {
@@ -47,7 +58,9 @@ unsigned long long timespec2ns(timespec ts) {
 }
 
 
-int main(int argc, char *argv[])
+// Run the task given by the arguments (as passed by clustering_launcher),
+// writing its results to @output
+int task_manager_main(int argc, char *argv[], FILE *output)
 {
 	// Process command line arguments	
 	const char *task_name = argv[0];
@@ -62,10 +75,15 @@ int main(int argc, char *argv[])
 		return RT_GOMP_TASK_MANAGER_ARG_COUNT_ERROR;
 	}
 	
+	// The first core is either a single core, the first of the range up to the
+	// last core, or an explicit list of the task's CPUs (e.g., 0-3,8-11)
+	std::string first_cores(argv[1]);
+	std::vector<unsigned> cpus;
+
 	unsigned num_iters;
 	long period_sec, period_ns, deadline_sec, deadline_ns, relative_release_sec, relative_release_ns;
 	if (!(
-		std::istringstream(argv[1]) >> first_core &&
+		parse_cpu_list(first_cores, cpus) &&
 		std::istringstream(argv[2]) >> last_core &&
 		std::istringstream(argv[3]) >> priority &&
 		std::istringstream(argv[4]) >> period_sec &&
@@ -84,6 +102,18 @@ int main(int argc, char *argv[])
 	
 	char *barrier_name = argv[11];
 
+	// A task that a heuristic partition left without any core (last core
+	// before the first) keeps an empty mask, so that its binding fails
+	if (first_cores.find_first_of(",-") == std::string::npos) {
+		unsigned first_core = cpus[0];
+		if (last_core < first_core) {
+			cpus.clear();
+		}
+		for (unsigned i = first_core + 1; i <= last_core; ++i) {
+			cpus.push_back(i);
+		}
+	}
+
 	int task_argc = argc - (num_req_args-1);
 	char **task_argv = &argv[num_req_args-1];
 
@@ -101,11 +131,12 @@ int main(int argc, char *argv[])
 	// Bind the task to the assigned cores
 	cpu_set_t mask;
 	CPU_ZERO(&mask);
-	for (unsigned i = first_core; i <= last_core; ++i) {
-		CPU_SET(i, &mask);
+	for (unsigned i = 0; i < cpus.size(); ++i) {
+		CPU_SET(cpus[i], &mask);
 	}
 	
-	int ret_val = sched_setaffinity(getpid(), sizeof(mask), &mask);
+	// Pid 0 is the calling thread, which is the whole task in a task process
+	int ret_val = sched_setaffinity(0, sizeof(mask), &mask);
 	if (ret_val != 0) {
 		perror("ERROR: Could not set CPU affinity");
 
@@ -122,17 +153,19 @@ int main(int argc, char *argv[])
 		}
 		
 		// Write to its output file saying that it failed
-		fprintf(stdout, "Binding failed !");
-		fflush(stdout);
+		fprintf(output, "Binding failed !");
+		fflush(output);
 
 		return RT_GOMP_TASK_MANAGER_CORE_BIND_ERROR;
 	}
 	
-	// Each task uses the highest real-time priority on its dedicated cores
+	// Each task uses the highest real-time priority on its dedicated cores.
+	// The tasks of an EDF pool start from the top priority of the pool,
+	// which is the same, and exchange priorities in the EDF order.
 	sched_param sp;
 	sp.sched_priority = 97;
 
-	ret_val = sched_setscheduler(getpid(), SCHED_FIFO, &sp);
+	ret_val = sched_setscheduler(0, SCHED_FIFO, &sp);
 	if (ret_val != 0)
 	{
 		perror("ERROR: Could not set process scheduler/priority");
@@ -160,6 +193,27 @@ int main(int argc, char *argv[])
 	omp_get_schedule(&omp_sched, &omp_mod);
 	fprintf(stderr, "OMP sched: %u %u\n", omp_sched, omp_mod);
 	
+	// With reclaiming, the task lends its CPUs while it waits for its next job,
+	// and its jobs can borrow the CPUs of the others (see core_lending.h).
+	// The task reads its lending state at init.
+	const char *lending_board_name = task_getenv("RT_GOMP_LENDING_BOARD");
+	LendingTask lending = {NULL, -1, 0};
+	uint64_t reclaim_guard = kDefaultReclaimGuard;
+
+	if (lending_board_name != NULL) {
+		lending.board = open_lending_board(lending_board_name);
+		if (lending.board != NULL) {
+			lending.slot = lending_join(lending.board);
+			set_lending_task(&lending);
+			if (task_getenv("RT_GOMP_RECLAIM_GUARD_NS") != NULL) {
+				reclaim_guard = strtoull(task_getenv("RT_GOMP_RECLAIM_GUARD_NS"), NULL, 10);
+			}
+		} else {
+			fprintf(stderr, "WARNING: Cannot open the lending board %s, reclaiming disabled for task %s\n",
+					lending_board_name, task_name);
+		}
+	}
+
 	fprintf(stderr, "Initializing task %s\n", task_name);
 
 	// Initialize the task
@@ -175,13 +229,88 @@ int main(int argc, char *argv[])
 	}
 
 
-	//Create storage for per-job timings
-	uint64_t *period_timings = (uint64_t*) malloc(num_iters * sizeof(uint64_t));
+	// If the launcher asked for a histogram of the response times, record them
+	// there (bounded memory) instead of storing every job's timings
+	const char *histogram_file = task_getenv("RT_GOMP_JOB_HISTOGRAM_FILE");
+	const char *record_file = task_getenv("RT_GOMP_JOB_RECORD_FILE");
+	LatencyHistogram histogram;
+	uint64_t *period_timings = NULL;
+
+	// The binary job records keep every field of job_record.h, the text
+	// output only the response time, which is their first field
+	unsigned num_stored_fields = (record_file != NULL) ? kJobRecordFields : 1;
 
-	if (period_timings == NULL) {
-		fprintf(stderr, "WARNING: Allocating memory for per-job execution times failed!\n");
+	if (histogram_file != NULL) {
+		init_histogram(histogram);
 	} else {
-		fprintf(stderr, "Allocating memory for per-job execution times success!\n");
+		//Create storage for per-job timings
+		period_timings = (uint64_t*) malloc(num_iters * num_stored_fields * sizeof(uint64_t));
+
+		if (period_timings == NULL) {
+			fprintf(stderr, "WARNING: Allocating memory for per-job execution times failed!\n");
+		} else {
+			fprintf(stderr, "Allocating memory for per-job execution times success!\n");
+		}
+	}
+
+	// If the launcher asked for hardware counters, open a group on each thread
+	// of the OpenMP team (created here if task.init did not) and keep the
+	// counts of every job
+	const char *perf_file = task_getenv("RT_GOMP_PERF_COUNTERS_FILE");
+	PerfCounters perf_counters;
+	uint64_t *perf_values = NULL, *perf_response_times = NULL;
+
+	if (perf_file != NULL && init_perf_counters(perf_counters, omp_get_max_threads())) {
+		#pragma omp parallel
+		{
+			open_thread_perf_counters(perf_counters, omp_get_thread_num());
+		}
+
+		// The workers of the pool that runs the strands of a synthetic task
+		// (also used to reclaim lent cores) are not in the team
+		const char *worker_pool = task_getenv("RT_GOMP_WORKER_POOL");
+		if ((worker_pool != NULL && strcmp(worker_pool, "1") == 0) || lending.board != NULL) {
+			fprintf(stderr, "WARNING: The worker pool is not counted, only the master thread of task %s is\n", task_name);
+			perf_counters.partial = true;
+		}
+
+		perf_values = (uint64_t*) malloc(num_iters * kPerfCounters * sizeof(uint64_t));
+		perf_response_times = (uint64_t*) malloc(num_iters * sizeof(uint64_t));
+		if (perf_values == NULL || perf_response_times == NULL) {
+			fprintf(stderr, "WARNING: Allocating memory for per-job counters failed!\n");
+			free(perf_values);
+			free(perf_response_times);
+			perf_values = NULL;
+			perf_response_times = NULL;
+			free_perf_counters(perf_counters);
+		}
+	} else if (perf_file != NULL) {
+		fprintf(stderr, "WARNING: Cannot allocate the counters of task %s\n", task_name);
+	}
+
+	// In the EDF pool of a hybrid partition, register the threads of the
+	// team so that the other pool tasks can change their priorities
+	const char *edf_pool_name = task_getenv("RT_GOMP_EDF_POOL");
+	EdfPool *edf_pool = NULL;
+	int edf_slot = -1;
+
+	if (edf_pool_name != NULL) {
+		edf_pool = open_edf_pool(edf_pool_name);
+		if (edf_pool != NULL) {
+			edf_slot = edf_pool_join(edf_pool);
+		}
+		if (edf_slot < 0) {
+			fprintf(stderr, "ERROR: Cannot join the EDF pool %s for task %s", edf_pool_name, task_name);
+			kill(0, SIGTERM);
+			return RT_GOMP_TASK_MANAGER_SET_PRIORITY_ERROR;
+		}
+
+		#pragma omp parallel
+		{
+			if (!edf_pool_add_thread(edf_pool, edf_slot)) {
+				fprintf(stderr, "WARNING: Too many threads in the EDF pool for task %s\n", task_name);
+			}
+		}
 	}
 
 	fprintf(stderr, "Task %s reached barrier\n", task_name);
@@ -200,6 +329,8 @@ int main(int argc, char *argv[])
 	timespec correct_period_start, actual_period_start, period_finish, period_runtime;
 	timespec max_period_runtime = {0, 0};
 	uint64_t total_nsec = 0;
+	JobRecordSummary summary;
+	init_job_summary(summary);
 	get_time(&correct_period_start);
 	correct_period_start = correct_period_start + relative_release;
 
@@ -209,14 +340,51 @@ int main(int argc, char *argv[])
 		// Every threads wait to the next period
 		sleep_until_ts(correct_period_start);
 
+		// Take back the CPUs lent while waiting
+		if (lending.board != NULL) {
+			withdraw_cpus(lending.board, lending.slot, cpus);
+		}
+
+		// Take the job's place in the EDF order of the pool
+		if (edf_pool != NULL) {
+			edf_pool_job_start(edf_pool, edf_slot, timespec2ns(correct_period_start) + timespec2ns(deadline));
+		}
+
+		// Read the counters outside of the job's response time
+		uint64_t perf_start[kPerfCounters];
+		if (perf_values != NULL) {
+			read_perf_counters(perf_counters, perf_start);
+		}
+
 		// Record the start time of this job
 		get_time(&actual_period_start);
 
+		// The job's deadline on the board's clock, from its intended release
+		if (lending.board != NULL) {
+			uint64_t release = timespec2ns(correct_period_start), start = timespec2ns(actual_period_start);
+			uint64_t relative_deadline = timespec2ns(deadline);
+			uint64_t latency = (start > release) ? std::min(start - release, relative_deadline) : 0;
+			lending.deadline = lending_now() + relative_deadline - latency;
+		}
+
 		ret_val = task.run(task_argc, task_argv);
 
 		// Record the finish time of this job
 		get_time(&period_finish);
 
+		if (edf_pool != NULL) {
+			edf_pool_job_finish(edf_pool, edf_slot);
+		}
+		lending.deadline = 0;
+
+		if (perf_values != NULL) {
+			uint64_t *job_counts = &perf_values[i * kPerfCounters];
+			read_perf_counters(perf_counters, job_counts);
+			for (unsigned c = 0; c < kPerfCounters; c++) {
+				job_counts[c] -= perf_start[c];
+			}
+		}
+
 		if (ret_val != 0)
 		{
 			fprintf(stderr, "ERROR: Task run failed for task %s", task_name);
@@ -227,19 +395,53 @@ int main(int argc, char *argv[])
 		ts_diff(actual_period_start, period_finish, period_runtime);
 
 		uint64_t time_in_nsec = period_runtime.tv_nsec + nsec_in_sec * period_runtime.tv_sec;
+		if (perf_values != NULL) {
+			perf_response_times[i] = time_in_nsec;
+		}
+
+		// Also measure the job from its intended release, to see the release latency
+		uint64_t job_fields[kJobRecordFields];
+		fill_job_record(job_fields, timespec2ns(correct_period_start), timespec2ns(actual_period_start),
+						timespec2ns(period_finish), timespec2ns(deadline));
+
 		if (i != 0) { // abort the first job
 			if (period_runtime > deadline) deadlines_missed += 1;
 			if (period_runtime > max_period_runtime) max_period_runtime = period_runtime;
 			total_nsec += time_in_nsec;
+			job_summary_add(summary, job_fields);
 		}
 
 		// Record the time for each job
-		period_timings[i] = time_in_nsec;
+		if (histogram_file != NULL) {
+			histogram_record(histogram, time_in_nsec);
+		} else if (period_timings != NULL) {
+			memcpy(&period_timings[i * num_stored_fields], job_fields, num_stored_fields * sizeof(uint64_t));
+		}
 
 		// Update the period_start time
 		correct_period_start = correct_period_start + period;
+
+		// Lend the CPUs until the guard time before the next job
+		if (lending.board != NULL && i+1 < num_iters) {
+			timespec now;
+			get_time(&now);
+			if (correct_period_start > now) {
+				uint64_t idle = timespec2ns(correct_period_start) - timespec2ns(now);
+				if (idle > 2*reclaim_guard) {
+					lend_cpus(lending.board, lending.slot, cpus, idle - reclaim_guard);
+				}
+			}
+		}
+	}
+
+	if (lending.board != NULL) {
+		withdraw_cpus(lending.board, lending.slot, cpus);
 	}
 
+	if (edf_pool != NULL) {
+		edf_pool_leave(edf_pool, edf_slot);
+		close_edf_pool(edf_pool, NULL);
+	}
 	
 	// Finalize the task
 	if (task.finalize != NULL) 
@@ -251,20 +453,69 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	if (lending.board != NULL) {
+		set_lending_task(NULL);
+		close_lending_board(lending.board, NULL);
+	}
+
 	// Write the recorded timings to the output file
-	fprintf(stdout,"Deadlines missed for task %s: %d/%d\n", task_name, deadlines_missed, num_iters);
-	fprintf(stdout,"Max running time for task %s: %i sec  %lu nsec\n", task_name, (int)max_period_runtime.tv_sec, max_period_runtime.tv_nsec);
-	fprintf(stdout,"Avg running time for task %s: %" PRIu64  " nsec\n", task_name, total_nsec/(num_iters-1));
+	fprintf(output,"Deadlines missed for task %s: %d/%d\n", task_name, deadlines_missed, num_iters);
+	fprintf(output,"Max running time for task %s: %i sec  %lu nsec\n", task_name, (int)max_period_runtime.tv_sec, max_period_runtime.tv_nsec);
+	fprintf(output,"Avg running time for task %s: %" PRIu64  " nsec\n", task_name, total_nsec/(num_iters-1));
+
+	// If the launcher asked for a summary of the release latencies and
+	// tardiness of the jobs, write it next to the output file
+	const char *summary_file = task_getenv("RT_GOMP_JOB_SUMMARY_FILE");
+	if (summary_file != NULL && !write_job_summary(summary_file, task_name, summary)) {
+		fprintf(stderr, "WARNING: Writing the job summary to %s failed for task %s\n", summary_file, task_name);
+	}
 
-	// SonDN (Jan 31, 2016): write the recorded response times to the file
-	for (unsigned i=0; i<num_iters; i++) {
-		fprintf(stdout, "%" PRIu64 "\n", period_timings[i]);
+	// If the launcher asked for a histogram or binary job records, write the
+	// response times there instead of one text line per job
+	if (histogram_file != NULL) {
+		if (!write_histogram(histogram_file, histogram)) {
+			fprintf(stderr, "WARNING: Writing the histogram to %s failed for task %s\n", histogram_file, task_name);
+		}
+	} else if (period_timings == NULL) {
+		fprintf(stderr, "WARNING: No per-job execution times to write for task %s\n", task_name);
+	} else if (record_file != NULL) {
+		JobRecordHeader header;
+		header.scheduler = JOB_RECORD_FS;
+		header.task_id = (task_getenv("RT_GOMP_TASK_ID") != NULL) ? atoi(task_getenv("RT_GOMP_TASK_ID")) : 0;
+		header.num_jobs = num_iters;
+		header.num_fields = kJobRecordFields;
+		header.period = timespec2ns(period);
+		header.deadline = timespec2ns(deadline);
+		if (!write_job_records(record_file, header, period_timings)) {
+			fprintf(stderr, "WARNING: Writing job records to %s failed for task %s\n", record_file, task_name);
+		}
+	} else {
+		// SonDN (Jan 31, 2016): write the recorded response times to the file
+		for (unsigned i=0; i<num_iters; i++) {
+			fprintf(output, "%" PRIu64 "\n", period_timings[i * num_stored_fields + JOB_RESPONSE_TIME]);
+		}
 	}
 	
+	if (perf_values != NULL) {
+		if (!write_perf_counters(perf_file, perf_counters, timespec2ns(deadline), num_iters, perf_response_times, perf_values)) {
+			fprintf(stderr, "WARNING: Writing counters to %s failed for task %s\n", perf_file, task_name);
+		}
+		free_perf_counters(perf_counters);
+	}
+
 	// Remember to free allocated memory
 	free(period_timings);
+	free(perf_values);
+	free(perf_response_times);
 
-	fflush(stdout);
+	fflush(output);
 	
 	return 0;
 }
+
+#ifndef RT_GOMP_TASK_HOST
+int main(int argc, char *argv[])
+{
+	return task_manager_main(argc, argv, stdout);
+}
+#endif
@@ -5,6 +5,7 @@
 #include <sstream>
 #include <string>
 #include <unistd.h>
+#include <stdlib.h>
 #include <stdio.h>
 #include <errno.h>
 #include <vector>
@@ -16,7 +17,9 @@
 #include <sys/stat.h>
 #include <signal.h>
 #include <omp.h>
-#include "litmus.h"
+#include "task_env.h"
+#include "taskset_io.h"
+#include "rt_backend.h"
 
 enum rt_gomp_clustering_launcher_error_codes
 { 
@@ -30,20 +33,41 @@ enum rt_gomp_clustering_launcher_error_codes
 };
 
 
-// Wait until all Litmus^RT's tasks are ready for release.
-// This is stolen from Litmus' release_ts.c
-void wait_until_ready(int expected) {
-	int ready =0, all = 0;
-	int loops = 0;
-	
-	do {
-		if (loops++ > 0)
-			sleep(1);
-		if (!read_litmus_stats(&ready, &all))
-			perror("read_litmus_stats");
-	} while (expected > ready || (!expected && ready < all));
-}
+// Default delay between the release call and the release of the first jobs
+const unsigned kDefaultReleaseDelayMs = 10;
 
+// Runtime per period of the threads of each task, so that the bandwidth
+// reserved for the task set stays within @capacity CPUs. Each task has
+// @num_threads threads. With the static schedule, a thread runs at most
+// ceil(n/m) of the n strands of a segment, so it needs up to C/m + L per
+// period; the span part is scaled down uniformly when the threads of all
+// the tasks do not fit. Return false if even the work C/m of every thread
+// does not fit, i.e., the utilization exceeds @capacity.
+static bool size_runtimes(const TaskSetSpec &ts, unsigned num_threads, double capacity,
+						  std::vector<uint64_t> &runtimes)
+{
+	double util = 0, span_bandwidth = 0;
+	for (unsigned i = 0; i < ts.tasks.size(); ++i) {
+		const TaskSpec &task = ts.tasks[i];
+		util += (double)task.work / task.period;
+		span_bandwidth += (double)num_threads * task.span / task.period;
+	}
+	if (util > capacity) {
+		return false;
+	}
+
+	double span_scale = 1;
+	if (util + span_bandwidth > capacity) {
+		span_scale = (capacity - util) / span_bandwidth;
+	}
+
+	runtimes.clear();
+	for (unsigned i = 0; i < ts.tasks.size(); ++i) {
+		const TaskSpec &task = ts.tasks[i];
+		runtimes.push_back((uint64_t) floor((double)task.work / num_threads + span_scale * task.span));
+	}
+	return true;
+}
 
 // Son (16 July, 2017) Program usage:
 // ./clustering_launcher_wlocks <full_path_to_rtps_file> [cluster_id]
@@ -83,9 +107,20 @@ int main(int argc, char *argv[])
 		return RT_GOMP_CLUSTERING_LAUNCHER_ARGUMENT_ERROR;
 	}
 	
+	// Define the name of the counter of the task threads ready for release
+	std::string counter_name = "/RT_GOMP_RELEASE_COUNTER";
+
 	// Append the third argument to the names of the shared memory objects
 	if (argc == 3) {
 		barrier_name += argv[2];
+		counter_name += argv[2];
+	}
+
+	// Delay of the release of the first jobs after all tasks are ready
+	// (RT_GOMP_RELEASE_DELAY_MS, in milliseconds)
+	unsigned release_delay_ms = kDefaultReleaseDelayMs;
+	if (getenv("RT_GOMP_RELEASE_DELAY_MS") != NULL) {
+		release_delay_ms = atoi(getenv("RT_GOMP_RELEASE_DELAY_MS"));
 	}
 	
 	// Determine the schedule (.rtps) filenames from the program argument
@@ -127,6 +162,8 @@ int main(int argc, char *argv[])
 				fprintf(stderr, "Taskset is schedulable with FS: %s\n", argv[1]);
 			} else if (schedulability == 1) {
 				fprintf(stderr, "WARNING: Taskset may not be schedulable with FS: %s\n", argv[1]);
+			} else if (schedulability == 3) {
+				fprintf(stderr, "Taskset is schedulable with FS and a shared EDF pool: %s\n", argv[1]);
 			} else {
 				fprintf(stderr, "WARNING: Taskset NOT schedulable with FS: %s", argv[1]);
 				return RT_GOMP_CLUSTERING_LAUNCHER_UNSCHEDULABLE_ERROR;
@@ -148,6 +185,29 @@ int main(int argc, char *argv[])
 		return RT_GOMP_CLUSTERING_LAUNCHER_FILE_PARSE_ERROR;
 	}
 	
+	// The backends that reserve bandwidth (SCHED_DEADLINE) admit the threads
+	// of the task set only if their runtimes fit in it
+	std::vector<uint64_t> runtimes;
+	double capacity = rt_bandwidth_capacity();
+	if (capacity > 0) {
+		TaskSetSpec spec;
+		if (!read_rtps(schedule_filename, spec)) {
+			return RT_GOMP_CLUSTERING_LAUNCHER_FILE_PARSE_ERROR;
+		}
+		if (!size_runtimes(spec, rt_num_cpus(), capacity, runtimes)) {
+			fprintf(stderr, "ERROR: Taskset needs more than the %.2f CPUs of bandwidth of %s: %s\n",
+					capacity, rt_backend_name(), argv[1]);
+			return RT_GOMP_CLUSTERING_LAUNCHER_UNSCHEDULABLE_ERROR;
+		}
+	}
+
+	// Create the counter of the task threads ready for release. Without it,
+	// we fall back to polling Litmus^RT (SCHED_DEADLINE cannot do without it).
+	ReleaseCounter *release_counter = create_release_counter(counter_name.c_str());
+	if (release_counter == NULL) {
+		perror("WARNING: Creating the release counter failed");
+	}
+
 	// Iterate over the tasks and fork and execv each one
 	std::string task_command_line, task_timing_line, task_partition_line;
 	for (unsigned t = 1; t <= num_tasks; ++t)
@@ -192,6 +252,11 @@ int main(int argc, char *argv[])
 				}
 			}
 			
+			// GEDF does not use the FS partition, nor its optional CPU list
+			// and EDF pool marker
+			std::string cpu_list, edf_pool_marker;
+			task_partition_stream >> cpu_list >> edf_pool_marker;
+
 			// Check for extra partition parameters
 			if (task_partition_stream >> partition_param) {
 				fprintf(stderr, "ERROR: Too many partition parameters were provided for task %s", program_name.c_str());
@@ -262,6 +327,21 @@ int main(int argc, char *argv[])
 				} else {
 					perror("Redirecting STDOUT failed.");
 				}
+
+				// Per-task options derived from the experiment-wide ones, e.g.,
+				// the files for binary job records or strand traces (see task_env.h)
+				TaskEnv task_env;
+				task_output_env(out_folder, t, "_gedf", task_env);
+				if (release_counter != NULL) {
+					task_env["RT_GOMP_RELEASE_COUNTER"] = counter_name;
+				}
+
+				if (!runtimes.empty()) {
+					std::ostringstream runtime;
+					runtime << runtimes[t-1];
+					task_env["RT_GOMP_DL_RUNTIME_NS"] = runtime.str();
+				}
+				export_task_env(task_env);
                 
 				// Const cast is necessary for type compatibility. Since the strings are
 				// not shared, there is no danger in removing the const modifier.
@@ -289,14 +369,14 @@ int main(int argc, char *argv[])
 	fprintf(stderr, "All tasks launched\n");
 
 	
-	// Now wait for all Litmus^RT's tasks to become waiting tasks, 
-	// then call release_ts() to release all of them synchronously.
-	// The number of Litmus^RT's tasks (i.e., Linux threads) waiting 
+	// Now wait for all real-time tasks to become waiting tasks, 
+	// then release all of them synchronously.
+	// The number of real-time tasks (i.e., Linux threads) waiting 
 	// is equal to (n*m) ((number of real-time tasks)*(total number of cores)).
-	int num_cores = num_online_cpus(); // Number of online CPUs
+	int num_cores = rt_num_cpus(); // Number of online CPUs
 	if (num_cores != omp_get_num_procs()) {
-		printf("WARNING: OMP and Litmus return different number of online CPUs!!\n");
-		printf("====== OMP: %d cores. Litmus: %d cores\n", omp_get_num_procs(), num_cores);
+		printf("WARNING: OMP and %s return different number of online CPUs!!\n", rt_backend_name());
+		printf("====== OMP: %d cores. %s: %d cores\n", omp_get_num_procs(), rt_backend_name(), num_cores);
 	}
 
 	int expected_waiters = num_tasks * num_cores;
@@ -304,12 +384,14 @@ int main(int argc, char *argv[])
 	//printf("INFO: Number of waiters: %d\n", get_nr_ts_release_waiters());
 
 	// Wait for all tasks to be ready, then release them.
-	wait_until_ready(expected_waiters);
+	rt_wait_until_ready(expected_waiters, release_counter);
 	
-	lt_t delay = ms2ns(1000);
-	int released_tasks = release_ts(&delay);
+	int released_tasks = rt_release(release_counter, expected_waiters, release_delay_ms);
+	if (release_counter != NULL) {
+		close_release_counter(release_counter, counter_name.c_str());
+	}
 	if (released_tasks != expected_waiters) {
-		printf("WARNING: Expected tasks: %d. Tasks released by Litmus^RT: %d\n", expected_waiters, released_tasks);
+		printf("WARNING: Expected tasks: %d. Tasks released by %s: %d\n", expected_waiters, rt_backend_name(), released_tasks);
 		//kill(0, SIGTERM);
 		//return RT_GOMP_CLUSTERING_LAUNCHER_FILE_PARSE_ERROR;
 	}
@@ -0,0 +1,56 @@
+// Real-time scheduling backend of the GEDF experiments.
+//
+// The task manager and the launcher reach the global EDF scheduler only
+// through these calls. Two backends implement them, selected at build time
+// (make BACKEND=litmus|deadline):
+//   rt_backend_litmus.cpp    Litmus^RT's GSN-EDF plugin, through liblitmus
+//   rt_backend_deadline.cpp  SCHED_DEADLINE of mainline Linux, whose root
+//                            domain is scheduled with global EDF
+// The functions returning an int return 0 on success, as liblitmus does.
+
+#ifndef RT_BACKEND_H
+#define RT_BACKEND_H
+
+#include <stdint.h>
+#include <time.h>
+#include "release_counter.h"
+
+// Name of the backend, for the logs
+const char *rt_backend_name();
+
+// Task side. Called once by the task process.
+int rt_backend_init();
+
+// Task side. Called by each thread of the task to make it a real-time thread
+// with the task's @period and @deadline. @runtime is the CPU time the thread
+// may use per period (ns), which the backend may ignore.
+int rt_thread_init(const timespec &period, const timespec &deadline, uint64_t runtime);
+
+// Task side. Called by each thread to wait for the synchronous release of
+// the task set. The thread has already arrived on @counter, if not NULL.
+// @release_time is set to the release time of the task set (ns,
+// CLOCK_MONOTONIC), or to 0 if the backend does not know it.
+int rt_thread_wait_release(ReleaseCounter *counter, uint64_t &release_time);
+
+// Task side. Called by each thread to sleep until its next job release.
+int rt_thread_sleep_next_period();
+
+// Task side. Called by each thread to leave real-time scheduling.
+int rt_thread_exit();
+
+// Launcher side. Number of CPUs the tasks are scheduled on.
+int rt_num_cpus();
+
+// Launcher side. Bandwidth the backend can reserve for the threads of the
+// tasks, in CPUs (e.g., the admission limit of SCHED_DEADLINE), or 0 if it
+// does not reserve bandwidth.
+double rt_bandwidth_capacity();
+
+// Launcher side. Wait until @expected task threads wait for the release.
+void rt_wait_until_ready(int expected, ReleaseCounter *counter);
+
+// Launcher side. Release the task set @delay_ms milliseconds from now.
+// Return the number of threads released, or -1 on error.
+int rt_release(ReleaseCounter *counter, int expected, unsigned delay_ms);
+
+#endif // RT_BACKEND_H
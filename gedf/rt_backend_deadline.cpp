@@ -0,0 +1,178 @@
+// SCHED_DEADLINE backend of the GEDF experiments. See rt_backend.h.
+//
+// Each thread of a task is a SCHED_DEADLINE entity with the task's period
+// and deadline. The tasks are not pinned, so they all belong to the root
+// domain, which the kernel schedules with global EDF. The runtime of a thread
+// is its budget per period, and a thread that uses it up is throttled until
+// its next period. The threads are created with SCHED_FLAG_RECLAIM so that
+// they run at the rate of the bandwidth left unused by the others (GRUB),
+// which delays the throttling only when some is left.
+//
+// The kernel admits a thread only if the bandwidth runtime/period of all
+// the SCHED_DEADLINE threads of the root domain stays within its share of
+// the CPUs for real-time (sched_rt_runtime_us/sched_rt_period_us, 95% by
+// default); the launcher sizes the runtimes so that the task set fits.
+//
+// The release is done through the release counter: the launcher publishes
+// the release time, the threads sleep until it, and then until each next
+// period with absolute clock_nanosleep on CLOCK_MONOTONIC.
+
+#include <errno.h>
+#include <math.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "rt_backend.h"
+
+#ifndef SCHED_DEADLINE
+#define SCHED_DEADLINE 6
+#endif
+
+const uint64_t kDlFlagResetOnFork = 0x01;
+const uint64_t kDlFlagReclaim = 0x02;
+
+// Smallest runtime and deadline accepted by the kernel (ns)
+const uint64_t kDlMinTime = 1024;
+
+// Fractional bits of the bandwidths in the admission control (BW_SHIFT)
+const unsigned kDlBandwidthShift = 20;
+
+// Argument of sched_setattr, as in include/uapi/linux/sched/types.h
+typedef struct {
+	uint32_t size;
+	uint32_t sched_policy;
+	uint64_t sched_flags;
+	int32_t sched_nice;
+	uint32_t sched_priority;
+	uint64_t sched_runtime;
+	uint64_t sched_deadline;
+	uint64_t sched_period;
+} DlSchedAttr;
+
+// Period and next release of the calling thread (ns)
+static __thread uint64_t thread_period;
+static __thread uint64_t thread_next_release;
+
+static uint64_t timespec_to_ns(const timespec &ts) {
+	return (uint64_t)ts.tv_sec*1000000000 + ts.tv_nsec;
+}
+
+static timespec ns_to_timespec(uint64_t ns) {
+	timespec ts;
+	ts.tv_sec = ns / 1000000000;
+	ts.tv_nsec = ns % 1000000000;
+	return ts;
+}
+
+static uint64_t monotonic_now() {
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return timespec_to_ns(ts);
+}
+
+// Read a number from a file of /proc. Return false if it cannot be read.
+static bool read_proc_value(const char *path, long &value) {
+	FILE *fp = fopen(path, "r");
+	if (fp == NULL) return false;
+	bool ok = (fscanf(fp, "%ld", &value) == 1);
+	fclose(fp);
+	return ok;
+}
+
+static int sched_setattr(const DlSchedAttr &attr) {
+	return syscall(SYS_sched_setattr, 0, &attr, 0);
+}
+
+// Sleep until the absolute time @ns of CLOCK_MONOTONIC
+static int sleep_until_ns(uint64_t ns) {
+	timespec ts = ns_to_timespec(ns);
+	int ret;
+	while ((ret = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL)) == EINTR);
+	return ret;
+}
+
+const char *rt_backend_name() {
+	return "SCHED_DEADLINE";
+}
+
+int rt_backend_init() {
+	return 0;
+}
+
+int rt_thread_init(const timespec &period, const timespec &deadline, uint64_t runtime) {
+	DlSchedAttr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.sched_policy = SCHED_DEADLINE;
+	attr.sched_flags = kDlFlagResetOnFork | kDlFlagReclaim;
+	attr.sched_period = timespec_to_ns(period);
+
+	// The kernel requires runtime <= deadline <= period
+	attr.sched_deadline = timespec_to_ns(deadline);
+	if (attr.sched_deadline > attr.sched_period) attr.sched_deadline = attr.sched_period;
+	if (attr.sched_deadline < kDlMinTime) attr.sched_deadline = kDlMinTime;
+	attr.sched_runtime = runtime;
+	if (attr.sched_runtime > attr.sched_deadline) attr.sched_runtime = attr.sched_deadline;
+	if (attr.sched_runtime < kDlMinTime) attr.sched_runtime = kDlMinTime;
+
+	thread_period = attr.sched_period;
+
+	// EBUSY means the admission control rejected the bandwidth runtime/period
+	return sched_setattr(attr);
+}
+
+int rt_thread_wait_release(ReleaseCounter *counter, uint64_t &release_time) {
+	release_time = 0;
+	if (counter == NULL) {
+		fprintf(stderr, "ERROR: SCHED_DEADLINE needs the release counter of the launcher\n");
+		return -1;
+	}
+
+	release_time = release_counter_wait_release(counter);
+	thread_next_release = release_time + thread_period;
+	return sleep_until_ns(release_time);
+}
+
+int rt_thread_sleep_next_period() {
+	int ret = sleep_until_ns(thread_next_release);
+	thread_next_release += thread_period;
+	return ret;
+}
+
+int rt_thread_exit() {
+	DlSchedAttr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.sched_policy = SCHED_OTHER;
+	return sched_setattr(attr);
+}
+
+int rt_num_cpus() {
+	return sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+double rt_bandwidth_capacity() {
+	long rt_runtime, rt_period;
+	double share = 0.95;
+	if (read_proc_value("/proc/sys/kernel/sched_rt_runtime_us", rt_runtime) &&
+		read_proc_value("/proc/sys/kernel/sched_rt_period_us", rt_period) && rt_period > 0) {
+		// -1 disables the limit
+		share = (rt_runtime < 0) ? 1.0 : (double)rt_runtime/rt_period;
+	}
+	// Rounded down as the kernel does, to kDlBandwidthShift bits
+	share = floor(share * (1 << kDlBandwidthShift)) / (1 << kDlBandwidthShift);
+	return share * rt_num_cpus();
+}
+
+void rt_wait_until_ready(int expected, ReleaseCounter *counter) {
+	if (counter == NULL) return;
+	while ((int)release_counter_wait(counter, expected, 1000) < expected);
+}
+
+int rt_release(ReleaseCounter *counter, int expected, unsigned delay_ms) {
+	if (counter == NULL) return -1;
+	release_counter_release(counter, monotonic_now() + (uint64_t)delay_ms*1000000);
+	return expected;
+}
@@ -0,0 +1,96 @@
+// Litmus^RT backend of the GEDF experiments. See rt_backend.h.
+
+#include <stdio.h>
+#include <unistd.h>
+#include "rt_backend.h"
+#include "litmus.h"
+
+// How often to check the Litmus^RT tasks once they have all announced themselves
+const unsigned kReadyPollUs = 100;
+
+// How long to sleep on the release counter before checking Litmus^RT anyway
+const unsigned kReadyTimeoutMs = 1000;
+
+static lt_t timespec_to_lt(const timespec &ts) {
+	return (lt_t)ts.tv_sec*1000000000 + ts.tv_nsec;
+}
+
+const char *rt_backend_name() {
+	return "Litmus^RT";
+}
+
+int rt_backend_init() {
+	return init_litmus();
+}
+
+int rt_thread_init(const timespec &period, const timespec &deadline, uint64_t runtime) {
+	struct rt_task params;
+	init_rt_task_param(&params);
+	params.exec_cost = timespec_to_lt(deadline);
+	params.period = timespec_to_lt(period);
+	params.relative_deadline = timespec_to_lt(deadline);
+	params.budget_policy = NO_ENFORCEMENT;
+
+	int ret = init_rt_thread();
+	if (ret != 0) return ret;
+
+	ret = set_rt_task_param(gettid(), &params);
+	if (ret != 0) return ret;
+
+	return task_mode(LITMUS_RT_TASK);
+}
+
+// Litmus^RT does not tell the release time of the task system, but the
+// user-space stand-in does
+int rt_thread_wait_release(ReleaseCounter *counter, uint64_t &release_time) {
+	int ret = wait_for_ts_release();
+#ifdef LITMUS_SHIM
+	release_time = ts_release_time();
+#else
+	release_time = 0;
+#endif
+	return ret;
+}
+
+int rt_thread_sleep_next_period() {
+	return sleep_next_period();
+}
+
+int rt_thread_exit() {
+	return task_mode(BACKGROUND_TASK);
+}
+
+int rt_num_cpus() {
+	return num_online_cpus();
+}
+
+// The GSN-EDF plugin does not reserve bandwidth
+double rt_bandwidth_capacity() {
+	return 0;
+}
+
+// This is stolen from Litmus' release_ts.c. The task threads count themselves
+// on @counter right before waiting for the release, so we sleep on it until
+// all are there, then only poll for the short time it takes them to enter
+// the kernel. Without a counter, poll every second as release_ts does.
+void rt_wait_until_ready(int expected, ReleaseCounter *counter) {
+	int ready =0, all = 0;
+	int loops = 0;
+	
+	do {
+		if (loops++ > 0) {
+			if (counter == NULL) {
+				sleep(1);
+			} else if ((int)release_counter_wait(counter, expected, kReadyTimeoutMs) >= expected) {
+				usleep(kReadyPollUs);
+			}
+		}
+		if (!read_litmus_stats(&ready, &all))
+			perror("read_litmus_stats");
+	} while (expected > ready || (!expected && ready < all));
+}
+
+int rt_release(ReleaseCounter *counter, int expected, unsigned delay_ms) {
+	lt_t delay = ms2ns(delay_ms);
+	return release_ts(&delay);
+}
@@ -1,20 +1,30 @@
 // The argument list of a synthetic task includes:
-// program-name num-segments {[num-strands len-sec len-ns] ...}
+// program-name num-segments {[num-strands len-sec len-ns [workload]] ...}
+// where the optional workload of a segment (e.g., chase:8M) is one of workload.h.
 
 #include <omp.h>
 #include <sstream>
 #include <string>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
 #include <iostream>
+#include <new>
+#include <vector>
+#include <algorithm>
 #include "task.h"
 #include "timespec_functions.h"
+#include "strand_trace.h"
+#include "worker_pool.h"
+#include "work_kernel.h"
+#include "workload.h"
+#include "task_env.h"
+#include "core_lending.h"
 
 using namespace std;
 
-extern int priority;
-extern unsigned first_core, last_core;
-
 const unsigned long kNanosecInSec = 1000000000;
 
 typedef struct {
@@ -22,6 +32,7 @@ typedef struct {
 	unsigned long len_sec;
 	unsigned long len_ns;
 	timespec len;
+	int workload; // index in the task's workloads, -1 to run the work kernel
 } Segment;
 
 typedef struct {
@@ -29,10 +40,63 @@ typedef struct {
 	Segment *segments;
 } Program;
 
+// CPU time consumed by the strands of each thread in the current job
+typedef struct {
+	uint64_t cpu_time;
+} __attribute__((aligned(64))) ThreadWork;
+
+// State of a synthetic task. Since task_host runs several tasks in one
+// process, each task has its own, created by init() and reached through
+// task_state from the thread that runs the task.
+typedef struct TaskState {
+	// Store structure of the task
+	// - A task consists of a list of segments (1st dimension)
+	Program program;
+
+	// Per-strand trace, enabled by setting RT_GOMP_STRAND_TRACE_FILE
+	// (RT_GOMP_STRAND_TRACE_EVENTS sets the number of events kept per thread)
+	const char *trace_file;
+	StrandTrace trace;
+
+	// Persistent workers that run the strands instead of an OpenMP parallel
+	// region per segment, enabled by setting RT_GOMP_WORKER_POOL=1
+	// (RT_GOMP_WORKER_POOL_SPIN sets how long idle workers spin before sleeping)
+	bool use_pool;
+	WorkerPool pool;
+
+	// CPUs borrowed from other tasks by a job that falls behind, when the task
+	// manager enables reclaiming (see core_lending.h). The pool is then always
+	// used, with a guest thread per CPU that can be borrowed at once
+	// (RT_GOMP_RECLAIM_GUESTS, by default as many as the task's threads).
+	LendingTask *lending;
+	unsigned num_guests;
+	vector<Loan> loans;
+	unsigned num_loans;
+
+	// Kernel run by the strands, selected by RT_GOMP_WORK_KERNEL (see work_kernel.h)
+	Work_Kernel work_kernel;
+	double loop_iterations_per_ns;
 
-// Store structure of the task
-// - A task consists of a list of segments (1st dimension)
-Program program;
+	// Workloads run by the segments that name one on the command line
+	vector<Workload> workloads;
+
+	// Report of the CPU time consumed by each job against the requested work,
+	// enabled by setting RT_GOMP_WORK_REPORT_FILE
+	const char *work_report_file;
+	ThreadWork *thread_work;
+	unsigned num_threads;
+	uint64_t requested_work;
+	vector<uint64_t> achieved_work;
+} TaskState;
+
+__thread TaskState *task_state;
+
+// A segment being run, passed to the threads running its strands
+typedef struct {
+	TaskState *state;
+	Segment *segment;
+	unsigned index;
+} SegmentRun;
 
 // Convert length in nanosecond to timespec
 timespec ns_to_timespec(unsigned long len) {
@@ -58,7 +122,7 @@ int init(int argc, char* argv[]) {
         fprintf(stderr, "ERROR: Two few arguments");
 	    return -1;
     }
-	
+
     unsigned num_segments;
     if (!(std::istringstream(argv[1]) >> num_segments))
     {
@@ -66,6 +130,16 @@ int init(int argc, char* argv[]) {
         return -1;
     }
 
+	// The state contains cache-line aligned members
+	void *memory;
+	if (posix_memalign(&memory, 64, sizeof(TaskState)) != 0) {
+		fprintf(stderr, "ERROR: Cannot allocate memory for the task state");
+		return -1;
+	}
+	task_state = new (memory) TaskState();
+	TaskState &state = *task_state;
+	Program &program = state.program;
+
 	// Allocate memory for storing pointers of segments
 	program.num_segments = num_segments;
 	program.segments = (Segment*) malloc(num_segments * sizeof(Segment));
@@ -76,6 +150,10 @@ int init(int argc, char* argv[]) {
 
 	// Keep track of current argument index
 	unsigned arg_idx = 2;
+
+	// Distinct workloads of the segments, and the most strands of a segment running each
+	vector<WorkloadSpec> workload_specs;
+	vector<unsigned> workload_strands;
 	for (unsigned i=0; i<num_segments; i++) {
 		unsigned num_strands;
 		if (!(std::istringstream(argv[arg_idx]) >> num_strands)) {
@@ -83,7 +161,7 @@ int init(int argc, char* argv[]) {
 			return -1;
 		}
 		arg_idx++;
-		
+
 		// Allocate memory for storing strands of this segment, NULL at the end
 		Segment *current_segment = &(program.segments[i]);
 		current_segment->num_strands = num_strands;
@@ -99,34 +177,325 @@ int init(int argc, char* argv[]) {
 		current_segment->len_ns = len_ns;
 		current_segment->len = {len_sec, len_ns};
 		arg_idx += 2;
+
+		// The segment's workload, if the next argument is not a number
+		current_segment->workload = -1;
+		if (arg_idx < (unsigned)argc && isalpha(argv[arg_idx][0])) {
+			WorkloadSpec spec;
+			if (!parse_workload(argv[arg_idx], spec)) {
+				fprintf(stderr, "ERROR: Unknown workload %s", argv[arg_idx]);
+				return -1;
+			}
+			arg_idx++;
+
+			unsigned w;
+			for (w=0; w<workload_specs.size(); w++) {
+				if (workload_specs[w].kernel == spec.kernel && workload_specs[w].working_set == spec.working_set) break;
+			}
+			if (w == workload_specs.size()) {
+				workload_specs.push_back(spec);
+				workload_strands.push_back(0);
+			}
+			if (num_strands > workload_strands[w]) workload_strands[w] = num_strands;
+			current_segment->workload = w;
+		}
+	}
+
+	// Allocate the working sets of the strands now, so that the jobs do not fault them in
+	state.workloads.resize(workload_specs.size());
+	for (unsigned w=0; w<workload_specs.size(); w++) {
+		if (!init_workload(state.workloads[w], workload_specs[w], workload_strands[w])) {
+			fprintf(stderr, "ERROR: Cannot allocate the working sets of the segments");
+			return -1;
+		}
+		fprintf(stderr, "Workload %u calibrated to %.4f units/ns\n", w, state.workloads[w].units_per_ns);
+	}
+
+	// The guests of the pool take thread indexes after the task's threads
+	state.lending = lending_task();
+	state.num_guests = 0;
+	state.num_loans = 0;
+	if (state.lending != NULL) {
+		state.num_guests = omp_get_max_threads();
+		const char *reclaim_guests = task_getenv("RT_GOMP_RECLAIM_GUESTS");
+		if (reclaim_guests != NULL) {
+			state.num_guests = atoi(reclaim_guests);
+		}
+		state.loans.resize(state.num_guests);
+	}
+	unsigned num_threads = omp_get_max_threads() + state.num_guests;
+
+	state.trace.enabled = false;
+	state.trace_file = task_getenv("RT_GOMP_STRAND_TRACE_FILE");
+	if (state.trace_file != NULL) {
+		unsigned capacity = kDefaultTraceEvents;
+		const char *trace_events = task_getenv("RT_GOMP_STRAND_TRACE_EVENTS");
+		if (trace_events != NULL) {
+			capacity = atoi(trace_events);
+		}
+		if (!init_strand_trace(state.trace, num_threads, capacity)) {
+			fprintf(stderr, "WARNING: Cannot allocate the strand trace, tracing disabled\n");
+		}
+	}
+
+	state.work_kernel = WORK_WALL_CLOCK;
+	const char *kernel_name = task_getenv("RT_GOMP_WORK_KERNEL");
+	if (kernel_name != NULL && !parse_work_kernel(kernel_name, state.work_kernel)) {
+		fprintf(stderr, "ERROR: Unknown work kernel %s", kernel_name);
+		return -1;
+	}
+	if (state.work_kernel == WORK_CALIBRATED_LOOP) {
+		state.loop_iterations_per_ns = calibrate_work_loop();
+		fprintf(stderr, "Work loop calibrated to %.3f iterations/ns\n", state.loop_iterations_per_ns);
+	}
+
+	state.thread_work = NULL;
+	state.work_report_file = task_getenv("RT_GOMP_WORK_REPORT_FILE");
+	if (state.work_report_file != NULL) {
+		state.num_threads = num_threads;
+		state.thread_work = (ThreadWork*) calloc(state.num_threads, sizeof(ThreadWork));
+		if (state.thread_work == NULL) {
+			fprintf(stderr, "ERROR: Cannot allocate memory for the work report");
+			return -1;
+		}
+
+		state.requested_work = 0;
+		for (unsigned i=0; i<num_segments; i++) {
+			Segment *segment = &(program.segments[i]);
+			state.requested_work += segment->num_strands * (segment->len_sec*kNanosecInSec + segment->len_ns);
+		}
+		state.achieved_work.reserve(1024);
+	}
+
+	// The pool distributes the strands as the OpenMP schedule set by the task manager
+	const char *worker_pool = task_getenv("RT_GOMP_WORKER_POOL");
+	state.use_pool = (worker_pool != NULL && strcmp(worker_pool, "1") == 0) || state.lending != NULL;
+	if (state.use_pool) {
+		omp_sched_t omp_sched;
+		int chunk;
+		omp_get_schedule(&omp_sched, &chunk);
+
+		unsigned spin = kDefaultPoolSpin;
+		const char *pool_spin = task_getenv("RT_GOMP_WORKER_POOL_SPIN");
+		if (pool_spin != NULL) {
+			spin = atoi(pool_spin);
+		}
+
+		if (!init_worker_pool(state.pool, omp_get_max_threads(), omp_sched != omp_sched_static, chunk, spin)) {
+			fprintf(stderr, "ERROR: Cannot start the worker pool");
+			state.use_pool = false;
+			return -1;
+		}
+		if (state.num_guests > 0 && !worker_pool_add_guests(state.pool, state.num_guests)) {
+			fprintf(stderr, "ERROR: Cannot start the guests of the worker pool");
+			return -1;
+		}
 	}
 
 	return 0;
 }
 
+// Do the work of strand @strand of the segment with its workload or the selected kernel
+void do_work(TaskState &state, Segment *segment, unsigned strand) {
+	if (segment->workload >= 0) {
+		workload_run(state.workloads[segment->workload], strand, segment->len_sec*kNanosecInSec + segment->len_ns);
+		return;
+	}
+
+	switch (state.work_kernel) {
+	case WORK_CPU_TIME:
+		cpu_time_work(segment->len_sec*kNanosecInSec + segment->len_ns);
+		break;
+	case WORK_CALIBRATED_LOOP:
+		calibrated_loop_work(segment->len_sec*kNanosecInSec + segment->len_ns, state.loop_iterations_per_ns);
+		break;
+	default:
+		busy_work(segment->len);
+		break;
+	}
+}
+
+// Run a strand of the segment run @arg on thread @thread
+void run_strand(void *arg, unsigned strand, unsigned thread) {
+	SegmentRun *segment_run = (SegmentRun*) arg;
+	TaskState &state = *segment_run->state;
+	Segment *segment = segment_run->segment;
+
+	uint64_t cpu_start = 0;
+	if (state.thread_work != NULL) {
+		cpu_start = thread_cpu_time();
+	}
+
+	if (state.trace.enabled) {
+		StrandEvent *event = strand_trace_begin(state.trace, thread, segment_run->index, strand);
+		do_work(state, segment, strand);
+		strand_trace_end(event);
+	} else {
+		do_work(state, segment, strand);
+	}
+
+	if (state.thread_work != NULL) {
+		state.thread_work[thread].cpu_time += thread_cpu_time() - cpu_start;
+	}
+}
+
+// Length of the strands of a segment in nanoseconds
+static uint64_t strand_len(const Segment *segment) {
+	return segment->len_sec*kNanosecInSec + segment->len_ns;
+}
+
+// Before segment @first of a job, keep the borrowed CPUs on which a strand of
+// the segment can still finish, and borrow more if the rest of the job cannot
+// finish by its deadline on the task's threads and the CPUs it holds
+static void borrow_cpus_for_segment(TaskState &state, unsigned first) {
+	LendingTask &lending = *state.lending;
+	WorkerPool &pool = state.pool;
+	uint64_t len = strand_len(&state.program.segments[first]);
+	uint64_t now = lending_now();
+
+	worker_pool_detach_guests(pool);
+	unsigned kept = 0;
+	for (unsigned k=0; k<state.num_loans; k++) {
+		if (state.loans[k].return_by >= now + len) {
+			state.loans[kept++] = state.loans[k];
+		} else {
+			return_cpus(lending.board, lending.slot, &state.loans[k], 1);
+		}
+	}
+	state.num_loans = kept;
+	if (lending.deadline == 0) return;
+
+	// Graham's bound of the rest of the job
+	double work = 0, span = 0;
+	for (unsigned i=first; i<state.program.num_segments; i++) {
+		const Segment *segment = &state.program.segments[i];
+		work += (double)segment->num_strands * strand_len(segment);
+		span += strand_len(segment);
+	}
+	double left = (lending.deadline > now) ? (double)(lending.deadline - now) : 0;
+	unsigned cores = pool.num_threads + state.num_loans;
+
+	if (span + (work - span)/cores > left && state.num_loans < state.num_guests) {
+		unsigned wanted = state.num_guests - state.num_loans;
+		if (left > span) {
+			double needed = ceil((work - span)/(left - span));
+			wanted = min(wanted, (unsigned)max(needed - cores, 1.0));
+		}
+		state.num_loans += borrow_cpus(lending.board, lending.slot, wanted, len, &state.loans[state.num_loans]);
+	}
+
+	for (unsigned k=0; k<state.num_loans; k++) {
+		worker_pool_attach_guest(pool, state.loans[k].cpu, state.loans[k].return_by);
+	}
+}
+
 int run(int argc, char *argv[])
 {
-	unsigned num_segments = program.num_segments;
+	TaskState &state = *task_state;
+	unsigned num_segments = state.program.num_segments;
 	for (unsigned i=0; i<num_segments; i++) {
-		Segment *segment = &(program.segments[i]);
+		Segment *segment = &(state.program.segments[i]);
 		unsigned num_strands = segment->num_strands;
+		SegmentRun segment_run = {&state, segment, i};
+
+		if (state.lending != NULL) {
+			borrow_cpus_for_segment(state, i);
+		}
 
-		#pragma omp parallel for schedule(runtime)
-		for (unsigned j=0; j<num_strands; j++) {
-			busy_work(segment->len);
+		// Trace the segment from the fork to the join
+		StrandEvent *segment_event = NULL;
+		if (state.trace.enabled) {
+			segment_event = strand_trace_begin(state.trace, 0, i, kSegmentEvent);
 		}
 
+		if (state.use_pool) {
+			worker_pool_run(state.pool, num_strands, run_strand, &segment_run, strand_len(segment));
+		} else {
+			#pragma omp parallel for schedule(runtime)
+			for (unsigned j=0; j<num_strands; j++) {
+				run_strand(&segment_run, j, omp_get_thread_num());
+			}
+		}
+
+		if (segment_event != NULL) {
+			strand_trace_end(segment_event);
+		}
 	}
-	
+
+	// Give back the borrowed CPUs at the end of the job
+	if (state.lending != NULL) {
+		worker_pool_detach_guests(state.pool);
+		if (state.num_loans > 0) {
+			return_cpus(state.lending->board, state.lending->slot, &state.loans[0], state.num_loans);
+			state.num_loans = 0;
+		}
+	}
+
+	state.trace.job++;
+
+	// Add up the CPU time of the job's strands
+	if (state.thread_work != NULL) {
+		uint64_t achieved = 0;
+		for (unsigned t=0; t<state.num_threads; t++) {
+			achieved += state.thread_work[t].cpu_time;
+			state.thread_work[t].cpu_time = 0;
+		}
+		state.achieved_work.push_back(achieved);
+	}
+
 	return 0;
 }
 
+// Write the achieved work of each job, as CPU time of its strands, against the requested work
+void write_work_report(const TaskState &state) {
+	FILE *fp = fopen(state.work_report_file, "w");
+	if (fp == NULL) {
+		fprintf(stderr, "WARNING: Cannot write the work report to %s\n", state.work_report_file);
+		return;
+	}
+
+	const char *kernel_names[] = {"wall", "cputime", "loop"};
+	fprintf(fp, "# kernel %s requested_ns %lu\n", kernel_names[state.work_kernel], (unsigned long)state.requested_work);
+	fprintf(fp, "# job achieved_ns achieved/requested\n");
+	for (unsigned i=0; i<state.achieved_work.size(); i++) {
+		fprintf(fp, "%u %lu %.4f\n", i, (unsigned long)state.achieved_work[i],
+				(double)state.achieved_work[i]/state.requested_work);
+	}
+	fclose(fp);
+}
+
 int finalize(int argc, char* argv[]) {
 
-	Segment *segments = program.segments;
+	TaskState &state = *task_state;
+	Segment *segments = state.program.segments;
 
 	free(segments);
-	program.segments = NULL;
+	state.program.segments = NULL;
+
+	if (state.use_pool) {
+		free_worker_pool(state.pool);
+	}
+
+	for (unsigned w=0; w<state.workloads.size(); w++) {
+		free_workload(state.workloads[w]);
+	}
+
+	if (state.thread_work != NULL) {
+		write_work_report(state);
+		free(state.thread_work);
+		state.thread_work = NULL;
+	}
+
+	if (state.trace.enabled) {
+		if (!write_strand_trace(state.trace_file, state.trace)) {
+			fprintf(stderr, "WARNING: Cannot write the strand trace to %s\n", state.trace_file);
+		}
+		free_strand_trace(state.trace);
+	}
+
+	state.~TaskState();
+	free(task_state);
+	task_state = NULL;
 
 	return 0;
 }
@@ -4,6 +4,8 @@
 #include <stdint.h> //For uint64_t
 #include <inttypes.h> //For PRIu64
 #include <stdlib.h> //For malloc
+#include <string.h> //For memcpy
+#include <errno.h>
 #include <sched.h>
 #include <unistd.h> 
 #include <stdio.h>
@@ -16,10 +18,14 @@
 #include <string>
 #include "task.h"
 #include "timespec_functions.h"
-#include "litmus.h"
+#include "job_record.h"
+#include "perf_counters.h"
+#include "latency_histogram.h"
+#include "release_counter.h"
+#include "rt_backend.h"
 
 
-// Macro to call to Litmus^RT syscalls
+// Macro to call to the real-time backend (Litmus^RT syscalls or SCHED_DEADLINE)
 #define CALL( exp ) do { \
 		int ret; \
 		ret = exp; \
@@ -58,24 +64,6 @@ unsigned long long timespec2ns(timespec ts) {
 }
 
 
-// Init parameters for Litmus^RT threads.
-// Call by each thread of the task.
-void init_thread_params() {
-	struct rt_task params;
-	init_rt_task_param(&params);
-	params.exec_cost = timespec2ns(deadline);
-	params.period = timespec2ns(period);
-	params.relative_deadline = timespec2ns(deadline);
-	params.budget_policy = NO_ENFORCEMENT;
-
-	CALL( init_rt_thread() );
-	
-	CALL( set_rt_task_param(gettid(), &params) );
-
-	CALL( task_mode(LITMUS_RT_TASK) );
-}
-
-
 int main(int argc, char *argv[])
 {
 	// Process command line arguments	
@@ -126,7 +114,7 @@ int main(int argc, char *argv[])
 		return RT_GOMP_TASK_MANAGER_RUN_TASK_ERROR;
 	}
 	
-	// Since we use Litmus^RT's GEDF to schedule the task, we don't need to set affinity
+	// Since we use the backend's GEDF to schedule the task, we don't need to set affinity
 	// Set OpenMP settings
 	// Disable dynamic adjustment of OpenMP thread team size
 	omp_set_dynamic(0);
@@ -151,6 +139,13 @@ int main(int argc, char *argv[])
 	omp_get_schedule(&omp_sched, &omp_mod);
 	fprintf(stderr, "OMP sched: %u %u\n", omp_sched, omp_mod);
 	
+	// The worker pool of synthetic tasks would run the strands on threads
+	// that are not real-time threads, so always use OpenMP under GEDF
+	if (getenv("RT_GOMP_WORKER_POOL") != NULL) {
+		fprintf(stderr, "WARNING: Worker pool is not supported with %s, using OpenMP for task %s\n", rt_backend_name(), task_name);
+		unsetenv("RT_GOMP_WORKER_POOL");
+	}
+
 	fprintf(stderr, "Initializing task %s\n", task_name);
 
 	// Initialize the task
@@ -166,23 +161,87 @@ int main(int argc, char *argv[])
 		}
 	}
 
-	// Call once to initialize liblitmus
-	init_litmus();
+	// Call once to initialize the backend (liblitmus)
+	CALL( rt_backend_init() );
+
+	// CPU time a thread may use per period, set by the launcher for the
+	// backends that reserve it (SCHED_DEADLINE); the deadline otherwise
+	uint64_t runtime = timespec2ns(deadline);
+	if (getenv("RT_GOMP_DL_RUNTIME_NS") != NULL) {
+		runtime = strtoull(getenv("RT_GOMP_DL_RUNTIME_NS"), NULL, 10);
+	}
 
-	// Called by each thread to set up its Litmus^RT parameters
+	// Called by each thread to set up its real-time parameters. A thread
+	// that the backend rejects, e.g., for lack of SCHED_DEADLINE bandwidth
+	// (EBUSY), would run under the default scheduler, so the run is aborted.
+	bool init_failed = false;
+	int init_errno = 0;
 #pragma omp parallel for schedule(static, 1)
 	for (int i = 0; i < num_cores; i++) {
-		init_thread_params();
+		if (rt_thread_init(period, deadline, runtime) != 0) {
+#pragma omp critical
+			{
+				init_failed = true;
+				init_errno = errno;
+			}
+		}
+	}
+	if (init_failed) {
+		fprintf(stderr, "ERROR: Cannot make the threads of task %s real-time with %s: %s\n",
+				task_name, rt_backend_name(), strerror(init_errno));
+		kill(0, SIGTERM);
+		return RT_GOMP_TASK_MANAGER_SET_PRIORITY_ERROR;
 	}
 
 
-	//Create storage for per-job timings
-	uint64_t *period_timings = (uint64_t*) malloc(num_iters * sizeof(uint64_t));
+	// If the launcher asked for a histogram of the response times, record them
+	// there (bounded memory) instead of storing every job's timings
+	const char *histogram_file = getenv("RT_GOMP_JOB_HISTOGRAM_FILE");
+	const char *record_file = getenv("RT_GOMP_JOB_RECORD_FILE");
+	LatencyHistogram histogram;
+	uint64_t *period_timings = NULL;
+
+	// The binary job records keep every field of job_record.h, the text
+	// output only the response time, which is their first field
+	unsigned num_stored_fields = (record_file != NULL) ? kJobRecordFields : 1;
 
-	if (period_timings == NULL) {
-		fprintf(stderr, "WARNING: Allocating memory for per-job execution times failed!\n");
+	if (histogram_file != NULL) {
+		init_histogram(histogram);
 	} else {
-		fprintf(stderr, "Allocating memory for per-job execution times success!\n");
+		//Create storage for per-job timings
+		period_timings = (uint64_t*) malloc(num_iters * num_stored_fields * sizeof(uint64_t));
+
+		if (period_timings == NULL) {
+			fprintf(stderr, "WARNING: Allocating memory for per-job execution times failed!\n");
+		} else {
+			fprintf(stderr, "Allocating memory for per-job execution times success!\n");
+		}
+	}
+
+	// If the launcher asked for hardware counters, open a group on each thread
+	// of the team set up above and keep the counts of every job
+	const char *perf_file = getenv("RT_GOMP_PERF_COUNTERS_FILE");
+	PerfCounters perf_counters;
+	uint64_t *perf_values = NULL, *perf_response_times = NULL;
+
+	if (perf_file != NULL && init_perf_counters(perf_counters, num_cores)) {
+#pragma omp parallel for schedule(static, 1)
+		for (int i = 0; i < num_cores; i++) {
+			open_thread_perf_counters(perf_counters, i);
+		}
+
+		perf_values = (uint64_t*) malloc(num_iters * kPerfCounters * sizeof(uint64_t));
+		perf_response_times = (uint64_t*) malloc(num_iters * sizeof(uint64_t));
+		if (perf_values == NULL || perf_response_times == NULL) {
+			fprintf(stderr, "WARNING: Allocating memory for per-job counters failed!\n");
+			free(perf_values);
+			free(perf_response_times);
+			perf_values = NULL;
+			perf_response_times = NULL;
+			free_perf_counters(perf_counters);
+		}
+	} else if (perf_file != NULL) {
+		fprintf(stderr, "WARNING: Cannot allocate the counters of task %s\n", task_name);
 	}
 
 	// Initialize timing controls
@@ -190,13 +249,47 @@ int main(int argc, char *argv[])
 	timespec period_start, period_finish, period_runtime;
 	timespec max_period_runtime = {0, 0};
 	uint64_t total_nsec = 0;
+	JobRecordSummary summary;
+	init_job_summary(summary);
 
 	fprintf(stderr, "Task %s reached barrier\n", task_name);
 
-	// Every threads wait for the task system release signal
+	// Tell the launcher when each thread is about to wait for the release,
+	// so that it does not have to poll the backend to know when all are ready
+	ReleaseCounter *release_counter = NULL;
+	const char *counter_name = getenv("RT_GOMP_RELEASE_COUNTER");
+	if (counter_name != NULL) {
+		release_counter = open_release_counter(counter_name);
+		if (release_counter == NULL) {
+			fprintf(stderr, "WARNING: Cannot open release counter %s for task %s\n", counter_name, task_name);
+		}
+	}
+
+	// Every threads wait for the task system release signal.
+	// The backend gives the release time when it knows it; under Litmus^RT,
+	// the return of the first thread stands for it, which hides its wake-up
+	// latency: the release latency of the later jobs is measured from the
+	// periods that follow it.
+	timespec task_release;
 #pragma omp parallel for schedule(static, 1)
 	for (int i = 0; i < num_cores; i++) {
-		CALL( wait_for_ts_release() );
+		if (release_counter != NULL) {
+			release_counter_arrive(release_counter);
+		}
+		uint64_t release_time;
+		CALL( rt_thread_wait_release(release_counter, release_time) );
+		if (i == 0) {
+			if (release_time != 0) {
+				task_release.tv_sec = release_time / nsec_in_sec;
+				task_release.tv_nsec = release_time % nsec_in_sec;
+			} else {
+				get_time(&task_release);
+			}
+		}
+	}
+
+	if (release_counter != NULL) {
+		close_release_counter(release_counter, NULL);
 	}
 
 	// After receiving the release signal (release_ts()),
@@ -205,7 +298,13 @@ int main(int argc, char *argv[])
 		// Every threads wait to the next period
 #pragma omp parallel for schedule(static, 1)
 		for (int i = 0; i < num_cores; i++) {
-			sleep_next_period();
+			rt_thread_sleep_next_period();
+		}
+
+		// Read the counters outside of the job's response time
+		uint64_t perf_start[kPerfCounters];
+		if (perf_values != NULL) {
+			read_perf_counters(perf_counters, perf_start);
 		}
 
 		// Record the start time of this job
@@ -216,6 +315,14 @@ int main(int argc, char *argv[])
 		// Record the finish time of this job
 		get_time(&period_finish);
 
+		if (perf_values != NULL) {
+			uint64_t *job_counts = &perf_values[i * kPerfCounters];
+			read_perf_counters(perf_counters, job_counts);
+			for (unsigned c = 0; c < kPerfCounters; c++) {
+				job_counts[c] -= perf_start[c];
+			}
+		}
+
 		if (ret_val != 0)
 		{
 			fprintf(stderr, "ERROR: Task run failed for task %s", task_name);
@@ -226,20 +333,36 @@ int main(int argc, char *argv[])
 		ts_diff(period_start, period_finish, period_runtime);
 
 		uint64_t time_in_nsec = period_runtime.tv_nsec + nsec_in_sec * period_runtime.tv_sec;
+		if (perf_values != NULL) {
+			perf_response_times[i] = time_in_nsec;
+		}
+
+		// Also measure the job from its intended release, one period after the
+		// previous one (the first job is released one period after the task)
+		uint64_t job_fields[kJobRecordFields];
+		uint64_t job_release = timespec2ns(task_release) + (uint64_t)(i+1) * timespec2ns(period);
+		fill_job_record(job_fields, job_release, timespec2ns(period_start),
+						timespec2ns(period_finish), timespec2ns(deadline));
+
 		if (i != 0) { // abort the first job
 			if (period_runtime > deadline) deadlines_missed += 1;
 			if (period_runtime > max_period_runtime) max_period_runtime = period_runtime;
 			total_nsec += time_in_nsec;
+			job_summary_add(summary, job_fields);
 		}
 
 		// Record the time for each job
-		period_timings[i] = time_in_nsec;
+		if (histogram_file != NULL) {
+			histogram_record(histogram, time_in_nsec);
+		} else if (period_timings != NULL) {
+			memcpy(&period_timings[i * num_stored_fields], job_fields, num_stored_fields * sizeof(uint64_t));
+		}
 	}
 
 	// Each thread return itself as a background task
 #pragma omp parallel for schedule(static, 1)
 	for (int i = 0; i < num_cores; i++) {
-		CALL( task_mode(BACKGROUND_TASK) );
+		CALL( rt_thread_exit() );
 	}
 	
 	
@@ -258,13 +381,50 @@ int main(int argc, char *argv[])
 	fprintf(stdout,"Max running time for task %s: %i sec  %lu nsec\n", task_name, (int)max_period_runtime.tv_sec, max_period_runtime.tv_nsec);
 	fprintf(stdout,"Avg running time for task %s: %" PRIu64  " nsec\n", task_name, total_nsec/(num_iters-1));
 
-	// SonDN (Jan 31, 2016): write the recorded response times to the file
-	for (unsigned i=0; i<num_iters; i++) {
-		fprintf(stdout, "%" PRIu64 "\n", period_timings[i]);
+	// If the launcher asked for a summary of the release latencies and
+	// tardiness of the jobs, write it next to the output file
+	const char *summary_file = getenv("RT_GOMP_JOB_SUMMARY_FILE");
+	if (summary_file != NULL && !write_job_summary(summary_file, task_name, summary)) {
+		fprintf(stderr, "WARNING: Writing the job summary to %s failed for task %s\n", summary_file, task_name);
+	}
+
+	// If the launcher asked for a histogram or binary job records, write the
+	// response times there instead of one text line per job
+	if (histogram_file != NULL) {
+		if (!write_histogram(histogram_file, histogram)) {
+			fprintf(stderr, "WARNING: Writing the histogram to %s failed for task %s\n", histogram_file, task_name);
+		}
+	} else if (period_timings == NULL) {
+		fprintf(stderr, "WARNING: No per-job execution times to write for task %s\n", task_name);
+	} else if (record_file != NULL) {
+		JobRecordHeader header;
+		header.scheduler = JOB_RECORD_GEDF;
+		header.task_id = (getenv("RT_GOMP_TASK_ID") != NULL) ? atoi(getenv("RT_GOMP_TASK_ID")) : 0;
+		header.num_jobs = num_iters;
+		header.num_fields = kJobRecordFields;
+		header.period = timespec2ns(period);
+		header.deadline = timespec2ns(deadline);
+		if (!write_job_records(record_file, header, period_timings)) {
+			fprintf(stderr, "WARNING: Writing job records to %s failed for task %s\n", record_file, task_name);
+		}
+	} else {
+		// SonDN (Jan 31, 2016): write the recorded response times to the file
+		for (unsigned i=0; i<num_iters; i++) {
+			fprintf(stdout, "%" PRIu64 "\n", period_timings[i * num_stored_fields + JOB_RESPONSE_TIME]);
+		}
 	}
 	
+	if (perf_values != NULL) {
+		if (!write_perf_counters(perf_file, perf_counters, timespec2ns(deadline), num_iters, perf_response_times, perf_values)) {
+			fprintf(stderr, "WARNING: Writing counters to %s failed for task %s\n", perf_file, task_name);
+		}
+		free_perf_counters(perf_counters);
+	}
+
 	// Remember to free allocated memory
 	free(period_timings);
+	free(perf_values);
+	free(perf_response_times);
 
 	fflush(stdout);
 	
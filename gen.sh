@@ -1,15 +1,11 @@
 #!/bin/bash
 
-FIRST_CORE=0
-LAST_CORE=15
+NUM_CORES=16
+NUM_TASKS=1:5
 TOTAL_UTIL=0.75
 
-for num_tasks in {1..5}
-do
-	for i in {1..100}
-	do
-		/usr/bin/python taskset_generate.py ${FIRST_CORE} ${LAST_CORE} ${num_tasks} ${TOTAL_UTIL}
-	done
-done
+# Generate 100 task sets for each number of tasks in one run, and write the
+# acceptance ratios of the analyses to data/sweep_num_tasks.txt (see tools/sweep.cpp)
+./tools/sweep -c 100 -d data -o data/sweep_num_tasks.txt -m ${NUM_CORES} -n ${NUM_TASKS} -u ${TOTAL_UTIL}
 
 echo "Finished!"
\ No newline at end of file
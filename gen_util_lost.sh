@@ -1,16 +1,12 @@
 #!/bin/bash
 
-FIRST_CORE=0
-LAST_CORE=15
+NUM_CORES=16
+NUM_TASKS=5
 TOTAL_UTIL=0.75
 TOTAL_UTIL_LOST=0.3125
 
-for num_tasks in 5
-do
-	for i in {1..100}
-	do
-		/usr/bin/python taskset_generate.py ${FIRST_CORE} ${LAST_CORE} ${num_tasks} ${TOTAL_UTIL} ${TOTAL_UTIL_LOST}
-	done
-done
+# Generate 100 task sets in one run, and write the acceptance ratios of the
+# analyses to data/sweep_util_lost.txt (see tools/sweep.cpp)
+./tools/sweep -c 100 -d data -o data/sweep_util_lost.txt -m ${NUM_CORES} -n ${NUM_TASKS} -u ${TOTAL_UTIL} -l ${TOTAL_UTIL_LOST}
 
 echo "Finished!"
\ No newline at end of file
@@ -0,0 +1,125 @@
+// User-space stand-in for liblitmus, for machines that cannot boot Litmus^RT.
+//
+// It implements the subset of the liblitmus API used by the GEDF experiments
+// with the same declarations, so that the gedf/ targets build and run
+// unchanged against it (make LITMUS=shim in gedf/):
+//   - synchronous release: the threads in wait_for_ts_release() sleep on a
+//     futex in shared memory until release_ts() publishes the release time,
+//     then sleep until that time with an absolute clock_nanosleep;
+//   - periodic jobs: sleep_next_period() sleeps until the thread's next
+//     release (release time + phase + k*period), absolute as well;
+//   - read_litmus_stats() reports the threads waiting for the release.
+// The threads are not scheduled with EDF: they keep their Linux scheduling
+// policy (see gedf/rt_backend.h for SCHED_DEADLINE). Timer slack is set to
+// 1 ns for real-time threads so that their wake-ups are not coalesced.
+//
+// The shared state is the POSIX shared memory object /LITMUS_SHIM, or the
+// name in LITMUS_SHIM_NAME, so that launchers running at the same time can
+// each have their own. Times are CLOCK_MONOTONIC.
+
+#ifndef LITMUS_SHIM_H
+#define LITMUS_SHIM_H
+
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/syscall.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef unsigned long long lt_t;
+
+typedef enum {
+	RT_CLASS_HARD,
+	RT_CLASS_SOFT,
+	RT_CLASS_BEST_EFFORT
+} task_class_t;
+
+typedef enum {
+	NO_ENFORCEMENT,
+	QUANTUM_ENFORCEMENT,
+	PRECISE_ENFORCEMENT
+} budget_policy_t;
+
+typedef enum {
+	TASK_SPORADIC,
+	TASK_PERIODIC,
+	TASK_EARLY
+} release_policy_t;
+
+struct rt_task {
+	lt_t exec_cost;
+	lt_t period;
+	lt_t relative_deadline;
+	lt_t phase;
+	unsigned int cpu;
+	unsigned int priority;
+	task_class_t cls;
+	budget_policy_t budget_policy;
+	release_policy_t release_policy;
+};
+
+// Defined by the stand-in only, for its extensions of the API
+#define LITMUS_SHIM 1
+
+#define LITMUS_LOWEST_PRIORITY 4095
+#define BACKGROUND_TASK 0
+#define LITMUS_RT_TASK 1
+
+static inline lt_t ms2ns(lt_t milliseconds) {
+	return milliseconds * 1000000ULL;
+}
+
+static inline lt_t us2ns(lt_t microseconds) {
+	return microseconds * 1000ULL;
+}
+
+#if !(defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 30)))
+static inline pid_t gettid(void) {
+	return syscall(SYS_gettid);
+}
+#endif
+
+// Current time (ns), the clock of the release times
+lt_t litmus_clock(void);
+
+// Map the shared state. Return 0 on success.
+int init_litmus(void);
+void exit_litmus(void);
+
+// Fill @param with default parameters
+void init_rt_task_param(struct rt_task *param);
+
+int init_rt_thread(void);
+
+// Set the parameters of the calling thread (@pid must be it, or 0)
+int set_rt_task_param(pid_t pid, struct rt_task *param);
+
+// Enter (LITMUS_RT_TASK) or leave (BACKGROUND_TASK) real-time mode
+int task_mode(int mode);
+
+// Sleep until the next release_ts(), then until the release time
+int wait_for_ts_release(void);
+
+// Extension: the time of the last release_ts(), 0 if none
+lt_t ts_release_time(void);
+
+// Release the waiting threads @delay ns from now. Return how many there were.
+int release_ts(lt_t *delay);
+
+// Number of threads waiting for the release, and of real-time threads.
+// Return nonzero on success.
+int read_litmus_stats(int *ready, int *total);
+
+// Sleep until the next release of the calling thread
+int sleep_next_period(void);
+
+int num_online_cpus(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LITMUS_SHIM_H
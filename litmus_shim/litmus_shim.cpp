@@ -0,0 +1,190 @@
+// User-space stand-in for liblitmus. See litmus.h.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <climits>
+#include <atomic>
+#include <new>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/stat.h>
+#include "litmus.h"
+
+using namespace std;
+
+static_assert(sizeof(atomic<uint32_t>) == sizeof(uint32_t), "futex words must be 32 bits");
+
+// State shared by the launcher and the task processes. A new object is all
+// zeros, which is a valid initial state.
+typedef struct {
+	atomic<uint32_t> release_seq; // incremented by each release_ts()
+	atomic<uint32_t> waiting; // threads in wait_for_ts_release()
+	atomic<uint32_t> rt_threads; // threads in real-time mode
+	atomic<uint64_t> release_time;
+} ShimState;
+
+static ShimState *shim_state = NULL;
+
+// Parameters and next release of the calling thread
+static __thread struct rt_task thread_params;
+static __thread bool thread_is_rt = false;
+static __thread lt_t thread_next_release;
+
+static void futex_wait(atomic<uint32_t> &word, uint32_t expected) {
+	syscall(SYS_futex, (uint32_t*)&word, FUTEX_WAIT, expected, NULL, NULL, 0);
+}
+
+static void futex_wake_all(atomic<uint32_t> &word) {
+	syscall(SYS_futex, (uint32_t*)&word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+// Sleep until the absolute time @t; return at once if it has passed
+static void sleep_until(lt_t t) {
+	timespec ts;
+	ts.tv_sec = t / 1000000000ULL;
+	ts.tv_nsec = t % 1000000000ULL;
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+}
+
+lt_t litmus_clock(void) {
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (lt_t)ts.tv_sec*1000000000ULL + ts.tv_nsec;
+}
+
+int init_litmus(void) {
+	if (shim_state != NULL) return 0;
+
+	const char *name = getenv("LITMUS_SHIM_NAME");
+	if (name == NULL) name = "/LITMUS_SHIM";
+
+	int fd = shm_open(name, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+	if (fd == -1) return -1;
+
+	// Only grows a new object, which is then zero-filled
+	struct stat st;
+	if (fstat(fd, &st) != 0 || ((size_t)st.st_size < sizeof(ShimState) && ftruncate(fd, sizeof(ShimState)) != 0)) {
+		close(fd);
+		return -1;
+	}
+
+	void *addr = mmap(NULL, sizeof(ShimState), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED) return -1;
+
+	shim_state = (ShimState*) addr;
+	return 0;
+}
+
+void exit_litmus(void) {
+	if (shim_state != NULL) {
+		munmap(shim_state, sizeof(ShimState));
+		shim_state = NULL;
+	}
+}
+
+void init_rt_task_param(struct rt_task *param) {
+	memset(param, 0, sizeof(*param));
+	param->cls = RT_CLASS_SOFT;
+	param->priority = LITMUS_LOWEST_PRIORITY;
+	param->budget_policy = NO_ENFORCEMENT;
+	param->release_policy = TASK_PERIODIC;
+}
+
+int init_rt_thread(void) {
+	return init_litmus();
+}
+
+int set_rt_task_param(pid_t pid, struct rt_task *param) {
+	if ((pid != 0 && pid != gettid()) || param->period == 0 ||
+		param->exec_cost == 0 || param->relative_deadline == 0) {
+		errno = EINVAL;
+		return -1;
+	}
+	thread_params = *param;
+	return 0;
+}
+
+int task_mode(int mode) {
+	if (shim_state == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (mode == LITMUS_RT_TASK && !thread_is_rt) {
+		if (thread_params.period == 0) {
+			errno = EINVAL;
+			return -1;
+		}
+		prctl(PR_SET_TIMERSLACK, 1UL);
+		shim_state->rt_threads.fetch_add(1);
+		thread_is_rt = true;
+		thread_next_release = litmus_clock();
+	} else if (mode == BACKGROUND_TASK && thread_is_rt) {
+		shim_state->rt_threads.fetch_sub(1);
+		thread_is_rt = false;
+	}
+	return 0;
+}
+
+int wait_for_ts_release(void) {
+	if (shim_state == NULL || !thread_is_rt) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	// Read the generation before counting ourselves, so that a release
+	// happening in between is not missed
+	uint32_t seq = shim_state->release_seq.load();
+	shim_state->waiting.fetch_add(1);
+	while (shim_state->release_seq.load() == seq) {
+		futex_wait(shim_state->release_seq, seq);
+	}
+
+	lt_t release = shim_state->release_time.load() + thread_params.phase;
+	sleep_until(release);
+	thread_next_release = release + thread_params.period;
+	return 0;
+}
+
+lt_t ts_release_time(void) {
+	if (shim_state == NULL) return 0;
+	return shim_state->release_time.load();
+}
+
+int release_ts(lt_t *delay) {
+	if (init_litmus() != 0) return -1;
+
+	shim_state->release_time.store(litmus_clock() + *delay);
+	int released = shim_state->waiting.exchange(0);
+	shim_state->release_seq.fetch_add(1);
+	futex_wake_all(shim_state->release_seq);
+	return released;
+}
+
+int read_litmus_stats(int *ready, int *total) {
+	if (init_litmus() != 0) return 0;
+
+	*ready = shim_state->waiting.load();
+	*total = shim_state->rt_threads.load();
+	return 1;
+}
+
+int sleep_next_period(void) {
+	if (!thread_is_rt) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	sleep_until(thread_next_release);
+	thread_next_release += thread_params.period;
+	return 0;
+}
+
+int num_online_cpus(void) {
+	return sysconf(_SC_NPROCESSORS_ONLN);
+}
@@ -0,0 +1,631 @@
+// This file aggregates the outputs of GEDF vs. FS experiments, as
+// gather_gedf_vs_fs.py and process_rtime did, for any number of experiment
+// folders, task sets and tasks.
+//
+// Usage: ./aggregate [-j num_threads] [-f] [-o percentiles_file] directory ...
+// Each directory holds the .rtps files of an experiment (or its .rtpt files
+// if it has no .rtps file), with the outputs of the runs of task set
+// taskset<i> in taskset<i>_output: task<j>.txt for FS and task<j>_gedf.txt
+// for GEDF, next to their .hist, .jobs and .perf files if the tasks wrote
+// them. The number of tasks of each task set and their deadlines are taken
+// from its task set file. The outputs of all tasks are read in parallel.
+//
+// For each directory, the output has a line with the FS partition statuses of
+// the .rtps files and the fraction of the valid task sets (status other than
+// 2) that FS or the hybrid partition schedules analytically (status 0 or 3),
+// then a line for each scheduler:
+//   <directory> <FS|GEDF> run <task sets> bind_failed <task sets> schedulable <fraction>
+//     jobs <jobs> missed <jobs> miss_ratio <fraction> p50 ... max <normalized response time>
+// A task set is run if all its tasks wrote their output; it is schedulable if
+// no job missed its deadline, out of the run task sets whose tasks could all
+// bind to their cores. The jobs, misses and quantiles of the response times
+// normalized by the deadlines are over all jobs of these task sets. If the
+// tasks recorded hardware counters (.perf files, see perf_counters.h), their
+// average per job is also reported for the jobs that met and missed their deadline,
+// with the number of these jobs whose counters are partial (only the master
+// thread counted).
+// With -o, the 99th percentile of the normalized response time of every task
+// run by both schedulers is written to @percentiles_file, one "<GEDF> <FS>"
+// line per task.
+//
+// The summary of every task's outputs is kept in aggregate_cache.txt in its
+// directory, keyed by the modification times of the output files, so that only
+// new or changed outputs are read again on the next run. With -f, the cache
+// is ignored and rebuilt.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <sys/stat.h>
+#include <cctype>
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include "taskset_io.h"
+#include "parallel_for.h"
+#include "job_record.h"
+#include "latency_histogram.h"
+#include "perf_counters.h"
+#include "partition.h"
+
+using namespace std;
+
+const char *const kCacheFile = "aggregate_cache.txt";
+const unsigned kCacheVersion = 2;
+
+// Normalized response times are merged in millionths of the deadline
+const uint64_t kNormalizedScale = 1000000;
+
+// Schedulers of the experiments, and the suffix of their tasks' output files
+enum Scheduler { SCHED_FS = 0, SCHED_GEDF = 1 };
+const unsigned kNumSchedulers = 2;
+const char *const kSchedulerNames[kNumSchedulers] = {"FS", "GEDF"};
+const char *const kSchedulerSuffixes[kNumSchedulers] = {"", "_gedf"};
+
+// Files that a task may write, with the bit of each in TaskOutput::files
+const char *const kOutputExtensions[] = {".txt", ".hist", ".jobs", ".perf"};
+const unsigned kNumOutputExtensions = sizeof(kOutputExtensions)/sizeof(kOutputExtensions[0]);
+
+enum Output_Status {
+	OUTPUT_MISSING = 0, // not run yet, or its output is incomplete
+	OUTPUT_BIND_FAILED = 1,
+	OUTPUT_DONE = 2
+};
+
+// Counters of the jobs of a task, for the jobs that met (0) and missed (1) their deadline
+typedef struct CounterTotals {
+	unsigned long long num_jobs[2];
+	unsigned long long num_partial[2]; // jobs of tasks whose counters are partial
+	unsigned long long num_counted[2][kPerfCounters];
+	double sums[2][kPerfCounters];
+} CounterTotals;
+
+// Non-empty buckets of a histogram, to keep it in the cache
+typedef struct SparseHistogram {
+	uint64_t total_count;
+	uint64_t min;
+	uint64_t max;
+	uint64_t sum;
+	vector<pair<unsigned, uint64_t> > buckets;
+} SparseHistogram;
+
+// Summary of the outputs of a task for a scheduler
+typedef struct TaskOutput {
+	// The cache key: the latest modification time (ns) of the task's files,
+	// which of them exist, and the task's deadline
+	uint64_t stamp;
+	unsigned files;
+	uint64_t deadline;
+
+	int status; // Output_Status
+	unsigned missed; // deadline misses reported by the task
+	unsigned jobs;
+	double p99; // 99th percentile of the normalized response times
+	SparseHistogram normalized; // response times in kNormalizedScale of the deadline
+	CounterTotals counters;
+} TaskOutput;
+
+// A task set of an experiment and the outputs of its tasks
+typedef struct TaskSetOutputs {
+	unsigned dir; // index of the directory
+	string file; // the task set file
+	string base; // its path without extension
+	bool valid; // whether the task set file could be read
+	int status; // FS partition status of a .rtps file, -1 for a .rtpt file
+	vector<uint64_t> deadlines;
+	vector<TaskOutput> outputs[kNumSchedulers];
+} TaskSetOutputs;
+
+// Totals of an experiment for a scheduler
+typedef struct SchedulerTotals {
+	unsigned run;
+	unsigned bind_failed;
+	unsigned schedulable;
+	unsigned long long jobs;
+	unsigned long long missed;
+	LatencyHistogram normalized;
+	CounterTotals counters;
+} SchedulerTotals;
+
+// A task's output to summarize
+typedef struct OutputItem {
+	unsigned taskset;
+	unsigned scheduler;
+	unsigned task;
+} OutputItem;
+
+// Path of the outputs of task @task (from 0) for @scheduler, without extension,
+// relative to the task set's path without extension
+string output_name(unsigned scheduler, unsigned task) {
+	return "_output/task" + to_string(task + 1) + kSchedulerSuffixes[scheduler];
+}
+
+// Key of the outputs of a task in the cache of its directory, e.g., taskset1_output/task1_gedf
+string cache_key(const TaskSetOutputs &taskset, unsigned scheduler, unsigned task) {
+	size_t slash = taskset.base.rfind('/');
+	string name = (slash == string::npos) ? taskset.base : taskset.base.substr(slash + 1);
+	return name + output_name(scheduler, task);
+}
+
+// Read the response times of a task's jobs from its histogram (<base>.hist)
+// or binary job records (<base>.jobs) if the task wrote them, or else from
+// its text output file (<base>.txt).
+bool read_response_times(const string &base, LatencyHistogram &response_times) {
+	if (read_histogram(base + ".hist", response_times)) {
+		return true;
+	}
+	init_histogram(response_times);
+
+	JobRecordReader reader;
+	if (open_job_records((base + ".jobs").c_str(), reader)) {
+		vector<uint64_t> values;
+		bool ok = read_job_field(reader, 0, values);
+		close_job_records(reader);
+		if (!ok) return false;
+
+		for (unsigned k=0; k<values.size(); k++) {
+			histogram_record(response_times, values[k]);
+		}
+		return true;
+	}
+
+	ifstream ifs((base + ".txt").c_str());
+	if (!ifs.is_open()) return false;
+
+	// Skip the summary lines at the top ("Deadlines missed ...", "Max ...")
+	string line;
+	while (getline(ifs, line)) {
+		if (line.empty() || !isdigit(line[0])) continue;
+		stringstream response_time_ss(line);
+		unsigned long long response_time;
+		response_time_ss >> response_time;
+		histogram_record(response_times, response_time);
+	}
+	return true;
+}
+
+// Read the status and the deadline misses of a task from its text output:
+// "Binding failed !" or "Deadlines missed for task <name>: <missed>/<jobs>"
+void read_task_summary(const string &base, TaskOutput &output) {
+	output.status = OUTPUT_MISSING;
+	ifstream ifs((base + ".txt").c_str());
+	string line;
+	while (getline(ifs, line)) {
+		if (line.compare(0, 14, "Binding failed") == 0) {
+			output.status = OUTPUT_BIND_FAILED;
+			return;
+		}
+		if (line.compare(0, 16, "Deadlines missed") == 0) {
+			size_t colon = line.rfind(':');
+			if (colon != string::npos &&
+				sscanf(line.c_str() + colon + 1, "%u/%u", &output.missed, &output.jobs) == 2) {
+				output.status = OUTPUT_DONE;
+			}
+			return;
+		}
+	}
+}
+
+// Add the counters of a task's jobs (<base>.perf) to the totals, if it recorded them
+void add_perf_counters(const string &base, CounterTotals &totals) {
+	uint64_t deadline;
+	bool partial;
+	vector<PerfJob> jobs;
+	if (!read_perf_file(base + ".perf", deadline, partial, jobs)) return;
+
+	// Abort the first job, as the task managers do
+	for (unsigned k=1; k<jobs.size(); k++) {
+		unsigned missed = (jobs[k].response_time > deadline) ? 1 : 0;
+		totals.num_jobs[missed]++;
+		if (partial) totals.num_partial[missed]++;
+		for (unsigned c=0; c<kPerfCounters; c++) {
+			if (jobs[k].values[c] < 0) continue;
+			totals.sums[missed][c] += jobs[k].values[c];
+			totals.num_counted[missed][c]++;
+		}
+	}
+}
+
+void add_counters(CounterTotals &dst, const CounterTotals &src) {
+	for (unsigned m=0; m<2; m++) {
+		dst.num_jobs[m] += src.num_jobs[m];
+		dst.num_partial[m] += src.num_partial[m];
+		for (unsigned c=0; c<kPerfCounters; c++) {
+			dst.num_counted[m][c] += src.num_counted[m][c];
+			dst.sums[m][c] += src.sums[m][c];
+		}
+	}
+}
+
+void to_sparse(const LatencyHistogram &hist, SparseHistogram &sparse) {
+	sparse.total_count = hist.total_count;
+	sparse.min = hist.min;
+	sparse.max = hist.max;
+	sparse.sum = hist.sum;
+	sparse.buckets.clear();
+	for (unsigned i=0; i<hist.counts.size(); i++) {
+		if (hist.counts[i] != 0) sparse.buckets.push_back(make_pair(i, hist.counts[i]));
+	}
+}
+
+void merge_sparse(LatencyHistogram &dst, const SparseHistogram &src) {
+	if (src.total_count == 0) return;
+	for (unsigned i=0; i<src.buckets.size(); i++) {
+		dst.counts[src.buckets[i].first] += src.buckets[i].second;
+	}
+	dst.total_count += src.total_count;
+	dst.sum += src.sum;
+	if (src.min < dst.min) dst.min = src.min;
+	if (src.max > dst.max) dst.max = src.max;
+}
+
+// Cache key of the outputs of a task: its files that exist and their latest modification time
+void stat_outputs(const string &base, TaskOutput &output) {
+	output.stamp = 0;
+	output.files = 0;
+	for (unsigned e=0; e<kNumOutputExtensions; e++) {
+		struct stat st;
+		if (stat((base + kOutputExtensions[e]).c_str(), &st) != 0) continue;
+		uint64_t mtime = st.st_mtim.tv_sec * 1000000000ULL + st.st_mtim.tv_nsec;
+		if (mtime > output.stamp) output.stamp = mtime;
+		output.files |= 1 << e;
+	}
+}
+
+// Summarize the outputs of a task (whose cache key is already set)
+void read_task_output(const string &base, TaskOutput &output) {
+	output.missed = 0;
+	output.jobs = 0;
+	output.p99 = 0;
+	output.counters = CounterTotals();
+	output.normalized = SparseHistogram();
+
+	read_task_summary(base, output);
+	if (output.status != OUTPUT_DONE) return;
+
+	LatencyHistogram response_times, normalized;
+	if (!read_response_times(base, response_times)) {
+		output.status = OUTPUT_MISSING;
+		return;
+	}
+	init_histogram(normalized);
+	histogram_merge_scaled(normalized, response_times, kNormalizedScale, output.deadline);
+	to_sparse(normalized, output.normalized);
+	output.p99 = (double)histogram_value_at_quantile(response_times, 0.99)/output.deadline;
+	add_perf_counters(base, output.counters);
+}
+
+// Read the cache of a directory into @cache, keyed by the output's path
+// relative to the directory, e.g., taskset1_output/task1_gedf
+void read_cache(const string &dir, map<string, TaskOutput> &cache) {
+	ifstream ifs((dir + "/" + kCacheFile).c_str());
+	string line;
+	unsigned version;
+	if (!getline(ifs, line) || sscanf(line.c_str(), "RTAGG %u", &version) != 1 || version != kCacheVersion) {
+		return;
+	}
+
+	while (getline(ifs, line)) {
+		istringstream line_stream(line);
+		string key;
+		TaskOutput output;
+		unsigned num_buckets;
+		line_stream >> key >> output.stamp >> output.files >> output.deadline >> output.status
+					>> output.missed >> output.jobs >> output.p99;
+		for (unsigned m=0; m<2; m++) {
+			line_stream >> output.counters.num_jobs[m] >> output.counters.num_partial[m];
+			for (unsigned c=0; c<kPerfCounters; c++) {
+				line_stream >> output.counters.num_counted[m][c] >> output.counters.sums[m][c];
+			}
+		}
+		SparseHistogram &hist = output.normalized;
+		line_stream >> hist.total_count >> hist.min >> hist.max >> hist.sum >> num_buckets;
+		for (unsigned i=0; i<num_buckets && line_stream; i++) {
+			pair<unsigned, uint64_t> bucket;
+			line_stream >> bucket.first >> bucket.second;
+			hist.buckets.push_back(bucket);
+		}
+		if (line_stream) cache[key] = output;
+	}
+}
+
+// Write the cache of a directory. Return false on failure.
+bool write_cache(const string &dir, const map<string, TaskOutput> &cache) {
+	string path = dir + "/" + kCacheFile;
+	string tmp_path = path + ".tmp";
+	FILE *fp = fopen(tmp_path.c_str(), "w");
+	if (fp == NULL) {
+		fprintf(stderr, "WARNING: Cannot write cache file %s\n", path.c_str());
+		return false;
+	}
+
+	fprintf(fp, "RTAGG %u\n", kCacheVersion);
+	map<string, TaskOutput>::const_iterator it;
+	for (it = cache.begin(); it != cache.end(); it++) {
+		const TaskOutput &output = it->second;
+		fprintf(fp, "%s %" PRIu64 " %u %" PRIu64 " %d %u %u %.17g", it->first.c_str(), output.stamp,
+				output.files, output.deadline, output.status, output.missed, output.jobs, output.p99);
+		for (unsigned m=0; m<2; m++) {
+			fprintf(fp, " %llu %llu", output.counters.num_jobs[m], output.counters.num_partial[m]);
+			for (unsigned c=0; c<kPerfCounters; c++) {
+				fprintf(fp, " %llu %.17g", output.counters.num_counted[m][c], output.counters.sums[m][c]);
+			}
+		}
+		const SparseHistogram &hist = output.normalized;
+		fprintf(fp, " %" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64 " %lu", hist.total_count, hist.min,
+				hist.max, hist.sum, hist.buckets.size());
+		for (unsigned i=0; i<hist.buckets.size(); i++) {
+			fprintf(fp, " %u %" PRIu64, hist.buckets[i].first, hist.buckets[i].second);
+		}
+		fprintf(fp, "\n");
+	}
+
+	bool ok = (fclose(fp) == 0) && (rename(tmp_path.c_str(), path.c_str()) == 0);
+	if (!ok) {
+		fprintf(stderr, "WARNING: Cannot write cache file %s\n", path.c_str());
+	}
+	return ok;
+}
+
+// Print the quantiles of the normalized response times of all jobs
+void print_quantiles(const LatencyHistogram &normalized) {
+	const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+	const char *labels[] = {"p50", "p90", "p99", "p99.9"};
+
+	for (unsigned i=0; i<sizeof(quantiles)/sizeof(quantiles[0]); i++) {
+		printf(" %s %.4f", labels[i], (double)histogram_value_at_quantile(normalized, quantiles[i])/kNormalizedScale);
+	}
+	printf(" max %.4f\n", (double)histogram_value_at_quantile(normalized, 1.0)/kNormalizedScale);
+}
+
+// Print the average counters per job of the jobs that met and missed their deadline
+void print_perf_counters(const string &dir, const char *name, const CounterTotals &totals) {
+	if (totals.num_jobs[0] + totals.num_jobs[1] == 0) return;
+
+	const char *labels[] = {"met", "missed"};
+	for (unsigned m=0; m<2; m++) {
+		printf("%s %s counters per job, %s deadline (%llu jobs", dir.c_str(), name, labels[m], totals.num_jobs[m]);
+		if (totals.num_partial[m] > 0) {
+			printf(", %llu partial", totals.num_partial[m]);
+		}
+		printf("):");
+		for (unsigned c=0; c<kPerfCounters; c++) {
+			if (totals.num_counted[m][c] == 0) {
+				printf(" %s -", kPerfCounterNames[c]);
+			} else {
+				printf(" %s %.1f", kPerfCounterNames[c], totals.sums[m][c]/totals.num_counted[m][c]);
+			}
+		}
+		if (totals.sums[m][PERF_CYCLES] > 0 && totals.num_counted[m][PERF_INSTRUCTIONS] > 0) {
+			printf(" ipc %.3f", totals.sums[m][PERF_INSTRUCTIONS]/totals.sums[m][PERF_CYCLES]);
+		}
+		printf("\n");
+	}
+}
+
+double fraction(unsigned long long count, unsigned long long total) {
+	return (total == 0) ? 0 : (double)count/total;
+}
+
+void usage(const char *program) {
+	fprintf(stderr, "Usage: %s [-j num_threads] [-f] [-o percentiles_file] directory ...\n", program);
+}
+
+int main(int argc, char *argv[]) {
+	unsigned num_threads = 0; // use all hardware threads by default
+	bool use_cache = true;
+	string percentiles_file;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "j:fo:")) != -1) {
+		switch (opt) {
+		case 'j':
+			num_threads = atoi(optarg);
+			break;
+		case 'f':
+			use_cache = false;
+			break;
+		case 'o':
+			percentiles_file = optarg;
+			break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (optind >= argc) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	// The task sets of all directories
+	vector<string> dirs;
+	vector<TaskSetOutputs> tasksets;
+	for (int i=optind; i<argc; i++) {
+		string dir(argv[i]);
+		if (!is_directory(dir)) {
+			fprintf(stderr, "ERROR: %s is not a directory\n", dir.c_str());
+			return 1;
+		}
+		vector<string> files = list_files(dir, ".rtps");
+		if (files.empty()) files = list_files(dir, ".rtpt");
+
+		for (unsigned f=0; f<files.size(); f++) {
+			TaskSetOutputs taskset;
+			taskset.dir = dirs.size();
+			taskset.file = files[f];
+			taskset.base = files[f].substr(0, files[f].size() - 5);
+			tasksets.push_back(taskset);
+		}
+		dirs.push_back(dir);
+	}
+
+	// Read the task set files for the number of tasks and their deadlines
+	parallel_for(tasksets.size(), num_threads, [&](unsigned i) {
+		TaskSetOutputs &taskset = tasksets[i];
+		TaskSetSpec spec;
+		bool rtps = (taskset.file.compare(taskset.base.size(), string::npos, ".rtps") == 0);
+		taskset.valid = rtps ? read_rtps(taskset.file, spec) : read_rtpt(taskset.file, spec);
+		if (!taskset.valid) return;
+
+		taskset.status = spec.status;
+		for (unsigned j=0; j<spec.tasks.size(); j++) {
+			taskset.deadlines.push_back(spec.tasks[j].deadline);
+		}
+	});
+
+	// Summarize the outputs of all tasks, or take them from the caches
+	vector<map<string, TaskOutput> > caches(dirs.size());
+	if (use_cache) {
+		parallel_for(dirs.size(), num_threads, [&](unsigned d) {
+			read_cache(dirs[d], caches[d]);
+		});
+	}
+
+	vector<OutputItem> items;
+	for (unsigned i=0; i<tasksets.size(); i++) {
+		if (!tasksets[i].valid) continue;
+		for (unsigned s=0; s<kNumSchedulers; s++) {
+			tasksets[i].outputs[s].resize(tasksets[i].deadlines.size());
+			for (unsigned j=0; j<tasksets[i].deadlines.size(); j++) {
+				OutputItem item = {i, s, j};
+				items.push_back(item);
+			}
+		}
+	}
+
+	vector<char> updated(items.size(), 0);
+	parallel_for(items.size(), num_threads, [&](unsigned k) {
+		const OutputItem &item = items[k];
+		const TaskSetOutputs &taskset = tasksets[item.taskset];
+		TaskOutput &output = tasksets[item.taskset].outputs[item.scheduler][item.task];
+		string base = taskset.base + output_name(item.scheduler, item.task);
+
+		stat_outputs(base, output);
+		output.deadline = taskset.deadlines[item.task];
+
+		const map<string, TaskOutput> &cache = caches[taskset.dir];
+		map<string, TaskOutput>::const_iterator it = cache.find(cache_key(taskset, item.scheduler, item.task));
+		if (it != cache.end() && it->second.stamp == output.stamp && it->second.files == output.files &&
+			it->second.deadline == output.deadline) {
+			output = it->second;
+			return;
+		}
+		read_task_output(base, output);
+		updated[k] = 1;
+	});
+
+	// Rewrite the caches of the directories with new or changed outputs
+	vector<char> dir_updated(dirs.size(), 0);
+	for (unsigned k=0; k<items.size(); k++) {
+		if (updated[k]) dir_updated[tasksets[items[k].taskset].dir] = 1;
+	}
+	vector<map<string, TaskOutput> > new_caches(dirs.size());
+	for (unsigned i=0; i<tasksets.size(); i++) {
+		const TaskSetOutputs &taskset = tasksets[i];
+		if (!taskset.valid || !dir_updated[taskset.dir]) continue;
+		for (unsigned s=0; s<kNumSchedulers; s++) {
+			for (unsigned j=0; j<taskset.outputs[s].size(); j++) {
+				new_caches[taskset.dir][cache_key(taskset, s, j)] = taskset.outputs[s][j];
+			}
+		}
+	}
+	for (unsigned d=0; d<dirs.size(); d++) {
+		if (dir_updated[d]) write_cache(dirs[d], new_caches[d]);
+	}
+
+	// Aggregate the task sets of each directory
+	FILE *percentiles = NULL;
+	if (!percentiles_file.empty()) {
+		percentiles = fopen(percentiles_file.c_str(), "w");
+		if (percentiles == NULL) {
+			fprintf(stderr, "ERROR: Cannot open file %s\n", percentiles_file.c_str());
+			return 1;
+		}
+		fprintf(percentiles, "#GEDF\tFS\n");
+	}
+
+	unsigned num_invalid = 0;
+	unsigned next = 0; // the task sets are in the order of their directories
+	for (unsigned d=0; d<dirs.size(); d++) {
+		unsigned statuses[PARTITION_HYBRID + 1] = {0};
+		unsigned num_tasksets = 0, num_rtps = 0;
+		SchedulerTotals totals[kNumSchedulers];
+		for (unsigned s=0; s<kNumSchedulers; s++) {
+			totals[s] = SchedulerTotals();
+			init_histogram(totals[s].normalized);
+		}
+
+		for (; next<tasksets.size() && tasksets[next].dir == d; next++) {
+			const TaskSetOutputs &taskset = tasksets[next];
+			if (!taskset.valid) {
+				num_invalid++;
+				continue;
+			}
+			num_tasksets++;
+			if (taskset.status >= 0 && taskset.status <= PARTITION_HYBRID) {
+				statuses[taskset.status]++;
+				num_rtps++;
+			}
+
+			for (unsigned s=0; s<kNumSchedulers; s++) {
+				const vector<TaskOutput> &outputs = taskset.outputs[s];
+				bool run = true, bind_failed = false, schedulable = true;
+				for (unsigned j=0; j<outputs.size(); j++) {
+					if (outputs[j].status == OUTPUT_MISSING) run = false;
+					if (outputs[j].status == OUTPUT_BIND_FAILED) bind_failed = true;
+					if (outputs[j].missed > 0) schedulable = false;
+				}
+				if (!run) continue;
+
+				SchedulerTotals &total = totals[s];
+				total.run++;
+				if (bind_failed) {
+					total.bind_failed++;
+					continue;
+				}
+				if (schedulable) total.schedulable++;
+				for (unsigned j=0; j<outputs.size(); j++) {
+					total.jobs += outputs[j].jobs;
+					total.missed += outputs[j].missed;
+					merge_sparse(total.normalized, outputs[j].normalized);
+					add_counters(total.counters, outputs[j].counters);
+				}
+			}
+
+			// The tasks run by both schedulers
+			for (unsigned j=0; percentiles != NULL && j<taskset.deadlines.size(); j++) {
+				const TaskOutput &fs = taskset.outputs[SCHED_FS][j], &gedf = taskset.outputs[SCHED_GEDF][j];
+				if (fs.status == OUTPUT_DONE && gedf.status == OUTPUT_DONE) {
+					fprintf(percentiles, "%g\t%g\n", gedf.p99, fs.p99);
+				}
+			}
+		}
+
+		const string &dir = dirs[d];
+		unsigned num_valid = num_rtps - statuses[INVALID];
+		printf("%s tasksets %u found %u heuristic %u invalid %u hybrid %u analysis %.4f\n", dir.c_str(),
+			   num_tasksets, statuses[PARTITION_FOUND], statuses[HEURISTIC_USED], statuses[INVALID],
+			   statuses[PARTITION_HYBRID], fraction(statuses[PARTITION_FOUND] + statuses[PARTITION_HYBRID], num_valid));
+		for (unsigned s=0; s<kNumSchedulers; s++) {
+			const SchedulerTotals &total = totals[s];
+			printf("%s %s run %u bind_failed %u schedulable %.4f jobs %llu missed %llu miss_ratio %.6f",
+				   dir.c_str(), kSchedulerNames[s], total.run, total.bind_failed,
+				   fraction(total.schedulable, total.run - total.bind_failed), total.jobs, total.missed,
+				   fraction(total.missed, total.jobs));
+			print_quantiles(total.normalized);
+		}
+		for (unsigned s=0; s<kNumSchedulers; s++) {
+			print_perf_counters(dir, kSchedulerNames[s], totals[s].counters);
+		}
+	}
+
+	if (percentiles != NULL) {
+		fclose(percentiles);
+	}
+	return (num_invalid == 0) ? 0 : 2;
+}
@@ -0,0 +1,129 @@
+// This file evaluates task sets analytically for both schedulers:
+// FS with the partitioning of partition_gedf_vs_fs (the Partition_Status that
+// would be written on the first line of the .rtps file), and GEDF with the
+// tests in gedf_analysis.h. GEDF uses all the system cores of the task set.
+//
+// Usage: ./analyze [-j num_threads] [-v] {rtpt_file | directory} ...
+// A directory argument evaluates every .rtpt file in it, in parallel.
+// Output has one line per task set:
+//   <rtpt_file> <total utilization> <FS partition status> <GEDF capacity test (0/1)> <GEDF RTA (0/1)>
+// With -v, each task set line is followed by the normalized response-time
+// bound (R/D) of every task from the GEDF response-time analysis.
+// The last lines (starting with #) give the number of task sets accepted by each test.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "taskset_io.h"
+#include "parallel_for.h"
+#include "partition.h"
+#include "gedf_analysis.h"
+
+using namespace std;
+
+// Analysis results of a task set
+typedef struct Result {
+	bool valid; // whether the task set file could be read
+	double util;
+	int fs_status;
+	bool gedf_capacity;
+	bool gedf_rta;
+	vector<double> normalized_bounds;
+} Result;
+
+void analyze_file(const string &rtpt_file, Result &result) {
+	TaskSetSpec spec;
+	result.valid = read_rtpt(rtpt_file, spec);
+	if (!result.valid) return;
+
+	unsigned num_cores = spec.sys_last_core - spec.sys_first_core + 1;
+	vector<DagTask> tasks = to_dag_tasks(spec.tasks);
+	result.util = total_utilization(tasks);
+
+	TaskSet ts;
+	init_taskset(spec.tasks, ts);
+	partition(ts, num_cores);
+	result.fs_status = ts.status;
+
+	vector<double> bounds;
+	result.gedf_capacity = gedf_capacity_augmentation_test(tasks, num_cores);
+	result.gedf_rta = gedf_response_time_test(tasks, num_cores, &bounds);
+	result.normalized_bounds.resize(tasks.size());
+	for (unsigned i=0; i<tasks.size(); i++) {
+		result.normalized_bounds[i] = bounds[i]/tasks[i].deadline;
+	}
+}
+
+void usage(const char *program) {
+	fprintf(stderr, "Usage: %s [-j num_threads] [-v] {rtpt_file | directory} ...\n", program);
+}
+
+int main(int argc, char *argv[]) {
+	unsigned num_threads = 0; // use all hardware threads by default
+	bool verbose = false;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "j:v")) != -1) {
+		switch (opt) {
+		case 'j':
+			num_threads = atoi(optarg);
+			break;
+		case 'v':
+			verbose = true;
+			break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (optind >= argc) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	vector<string> rtpt_files;
+	for (int i=optind; i<argc; i++) {
+		string path(argv[i]);
+		if (is_directory(path)) {
+			vector<string> files = list_files(path, ".rtpt");
+			rtpt_files.insert(rtpt_files.end(), files.begin(), files.end());
+		} else {
+			rtpt_files.push_back(path);
+		}
+	}
+
+	vector<Result> results(rtpt_files.size());
+	parallel_for(rtpt_files.size(), num_threads, [&](unsigned i) {
+		analyze_file(rtpt_files[i], results[i]);
+	});
+
+	// Print the results in the order of the files
+	unsigned num_valid = 0, fs_count = 0, capacity_count = 0, rta_count = 0;
+	for (unsigned i=0; i<results.size(); i++) {
+		const Result &result = results[i];
+		if (!result.valid) continue;
+
+		num_valid++;
+		if (result.fs_status == PARTITION_FOUND) fs_count++;
+		if (result.gedf_capacity) capacity_count++;
+		if (result.gedf_rta) rta_count++;
+
+		printf("%s %.4f %d %d %d\n", rtpt_files[i].c_str(), result.util, result.fs_status,
+			   result.gedf_capacity ? 1 : 0, result.gedf_rta ? 1 : 0);
+		if (verbose) {
+			for (unsigned j=0; j<result.normalized_bounds.size(); j++) {
+				printf("  task%u %.4f\n", j+1, result.normalized_bounds[j]);
+			}
+		}
+	}
+
+	printf("# Task sets: %u\n", num_valid);
+	printf("# FS partition found: %u\n", fs_count);
+	printf("# GEDF capacity augmentation test: %u\n", capacity_count);
+	printf("# GEDF response-time test: %u\n", rta_count);
+
+	return (num_valid == rtpt_files.size()) ? 0 : 2;
+}
@@ -0,0 +1,147 @@
+// This file measures the fork/join overhead per segment of the ways a
+// synthetic task can run the strands of a segment: an OpenMP parallel region
+// with the static schedule (as under GEDF) or the dynamic schedule (as under
+// FS), both with chunk 1, and the persistent worker pool of worker_pool.h
+// with the same two distributions.
+//
+// Usage: ./fork_join_bench [-t num_threads] [-s num_strands] [-l strand_ns]
+//                          [-n num_segments] [-g gap_ns] [-w pool_spin]
+// The overhead of a segment is its duration minus the duration of its strands
+// on the critical path, i.e., ceil(num_strands/num_threads)*strand_ns.
+// With a gap between segments longer than the spinning time of the pool,
+// the workers go to sleep and the overhead includes their wake-up.
+// Output has one line per method:
+//   <method> <mean overhead> <p50> <p99> <max> (ns)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <omp.h>
+#include "latency_histogram.h"
+#include "strand_trace.h"
+#include "worker_pool.h"
+
+using namespace std;
+
+// Spin for @len ns
+void spin_for(uint64_t len) {
+	if (len == 0) return;
+	uint64_t end = strand_trace_now() + len;
+	while (strand_trace_now() < end);
+}
+
+void pool_strand(void *arg, unsigned strand, unsigned thread) {
+	spin_for(*(uint64_t*)arg);
+}
+
+void print_overheads(const char *method, const LatencyHistogram &overheads) {
+	printf("%-12s %10.0f %10llu %10llu %10llu\n", method, histogram_mean(overheads),
+		   (unsigned long long)histogram_value_at_quantile(overheads, 0.5),
+		   (unsigned long long)histogram_value_at_quantile(overheads, 0.99),
+		   (unsigned long long)histogram_value_at_quantile(overheads, 1.0));
+}
+
+void usage(const char *program) {
+	fprintf(stderr, "Usage: %s [-t num_threads] [-s num_strands] [-l strand_ns] [-n num_segments] [-g gap_ns] [-w pool_spin]\n", program);
+}
+
+int main(int argc, char *argv[]) {
+	unsigned num_threads = omp_get_num_procs();
+	unsigned num_strands = 0; // one strand per thread by default
+	uint64_t strand_len = 0;
+	unsigned num_segments = 10000;
+	uint64_t gap = 0;
+	unsigned spin = kDefaultPoolSpin;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "t:s:l:n:g:w:")) != -1) {
+		switch (opt) {
+		case 't':
+			num_threads = atoi(optarg);
+			break;
+		case 's':
+			num_strands = atoi(optarg);
+			break;
+		case 'l':
+			strand_len = strtoull(optarg, NULL, 10);
+			break;
+		case 'n':
+			num_segments = atoi(optarg);
+			break;
+		case 'g':
+			gap = strtoull(optarg, NULL, 10);
+			break;
+		case 'w':
+			spin = atoi(optarg);
+			break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (num_threads == 0 || num_segments == 0) {
+		usage(argv[0]);
+		return 1;
+	}
+	if (num_strands == 0) {
+		num_strands = num_threads;
+	}
+
+	uint64_t critical_path = ((num_strands + num_threads - 1)/num_threads)*strand_len;
+	printf("# threads %u strands %u strand_ns %llu segments %u gap_ns %llu\n", num_threads, num_strands,
+		   (unsigned long long)strand_len, num_segments, (unsigned long long)gap);
+	printf("# %-10s %10s %10s %10s %10s\n", "method", "mean", "p50", "p99", "max");
+
+	omp_set_dynamic(0);
+	omp_set_nested(0);
+	omp_set_num_threads(num_threads);
+
+	const char *omp_methods[] = {"omp-static", "omp-dynamic"};
+	const omp_sched_t omp_scheds[] = {omp_sched_static, omp_sched_dynamic};
+	for (unsigned m=0; m<2; m++) {
+		omp_set_schedule(omp_scheds[m], 1);
+		LatencyHistogram overheads;
+		init_histogram(overheads);
+
+		// The first segment creates the OpenMP threads and is not measured
+		for (unsigned i=0; i<=num_segments; i++) {
+			spin_for(gap);
+			uint64_t start = strand_trace_now();
+			#pragma omp parallel for schedule(runtime)
+			for (unsigned j=0; j<num_strands; j++) {
+				spin_for(strand_len);
+			}
+			uint64_t duration = strand_trace_now() - start;
+			if (i != 0) {
+				histogram_record(overheads, (duration > critical_path) ? duration - critical_path : 0);
+			}
+		}
+		print_overheads(omp_methods[m], overheads);
+	}
+
+	const char *pool_methods[] = {"pool-static", "pool-dynamic"};
+	for (unsigned m=0; m<2; m++) {
+		WorkerPool pool;
+		if (!init_worker_pool(pool, num_threads, m == 1, 1, spin, false)) {
+			fprintf(stderr, "ERROR: Cannot start the worker pool\n");
+			return 2;
+		}
+
+		LatencyHistogram overheads;
+		init_histogram(overheads);
+		for (unsigned i=0; i<=num_segments; i++) {
+			spin_for(gap);
+			uint64_t start = strand_trace_now();
+			worker_pool_run(pool, num_strands, pool_strand, &strand_len);
+			uint64_t duration = strand_trace_now() - start;
+			if (i != 0) {
+				histogram_record(overheads, (duration > critical_path) ? duration - critical_path : 0);
+			}
+		}
+		free_worker_pool(pool);
+		print_overheads(pool_methods[m], overheads);
+	}
+
+	return 0;
+}
@@ -0,0 +1,122 @@
+// Analytical schedulability tests for parallel tasks under GEDF.
+// See gedf_analysis.h for the tests.
+
+#include <cmath>
+#include <algorithm>
+#include "gedf_analysis.h"
+
+using namespace std;
+
+// The capacity augmentation bound of GEDF for parallel tasks
+const double kGedfCapacityBound = (3 + sqrt(5.0))/2;
+
+// Stop the fixed-point iteration when the response time changes less than this (ns)
+const double kPrecision = 1.0;
+
+// Bounds on the number of iterations, in case the fixed point is approached too slowly
+const unsigned kMaxFixedPointIterations = 1000;
+const unsigned kMaxRefinementRounds = 100;
+
+vector<DagTask> to_dag_tasks(const vector<TaskSpec> &tasks) {
+	vector<DagTask> dag_tasks(tasks.size());
+	for (unsigned i=0; i<tasks.size(); i++) {
+		dag_tasks[i].work = tasks[i].work;
+		dag_tasks[i].span = tasks[i].span;
+		dag_tasks[i].period = tasks[i].period;
+		dag_tasks[i].deadline = tasks[i].deadline;
+	}
+	return dag_tasks;
+}
+
+double total_utilization(const vector<DagTask> &tasks) {
+	double util = 0;
+	for (unsigned i=0; i<tasks.size(); i++) {
+		util += tasks[i].work/tasks[i].period;
+	}
+	return util;
+}
+
+bool gedf_capacity_augmentation_test(const vector<DagTask> &tasks, unsigned m) {
+	// The bound is for implicit deadlines. For constrained deadlines,
+	// use densities and deadlines instead, which is safe.
+	double density = 0;
+	for (unsigned i=0; i<tasks.size(); i++) {
+		double window = min(tasks[i].deadline, tasks[i].period);
+		if (tasks[i].span > window/kGedfCapacityBound) return false;
+		density += tasks[i].work/window;
+	}
+	return (density <= m/kGedfCapacityBound);
+}
+
+// Upper bound on the workload of a task in any window of length t, when its
+// jobs finish within @response of their releases. The first job in the window
+// (carry-in) is assumed to run as late as possible on all m cores.
+double carry_in_workload(const DagTask &task, double response, double t, unsigned m) {
+	double x = t + response - task.work/m;
+	if (x <= 0) return 0;
+	double jobs = floor(x/task.period);
+	return jobs*task.work + min(task.work, m*(x - jobs*task.period));
+}
+
+// Upper bound on the workload of a task with deadlines inside a window of
+// length @window (EDF only lets such jobs interfere), when its jobs finish at
+// least (deadline - @response) before their deadlines.
+double deadline_window_workload(const DagTask &task, double response, double window, unsigned m) {
+	double jobs = max(0.0, floor((window - task.deadline)/task.period) + 1);
+	double slack = max(0.0, task.deadline - response);
+	double carry_in = max(0.0, window - jobs*task.period - slack);
+	return jobs*task.work + min(task.work, m*carry_in);
+}
+
+bool gedf_response_time_test(const vector<DagTask> &tasks, unsigned m, vector<double> *response_bounds) {
+	unsigned num_tasks = tasks.size();
+
+	// Response times assumed for the interfering tasks. Deadlines are safe
+	// initial values, since we check whether every task meets its deadline.
+	vector<double> assumed(num_tasks);
+	vector<double> bounds(num_tasks);
+	for (unsigned i=0; i<num_tasks; i++) {
+		assumed[i] = tasks[i].deadline;
+	}
+
+	bool schedulable = true;
+	for (unsigned round=0; round<kMaxRefinementRounds; round++) {
+		bool changed = false;
+		schedulable = true;
+
+		for (unsigned k=0; k<num_tasks; k++) {
+			const DagTask &task = tasks[k];
+			double base = task.span + (task.work - task.span)/m;
+			double response = base;
+
+			for (unsigned iter=0; iter<kMaxFixedPointIterations && response <= task.deadline; iter++) {
+				double interference = 0;
+				for (unsigned i=0; i<num_tasks; i++) {
+					if (i == k) continue;
+					interference += min(carry_in_workload(tasks[i], assumed[i], response, m),
+										deadline_window_workload(tasks[i], assumed[i], task.deadline, m));
+				}
+
+				double new_response = base + interference/m;
+				bool converged = (new_response - response < kPrecision);
+				response = new_response;
+				if (converged) break;
+			}
+
+			bounds[k] = response;
+			if (response > task.deadline) {
+				schedulable = false;
+			} else if (response < assumed[k]) {
+				assumed[k] = response;
+				changed = true;
+			}
+		}
+
+		if (!changed) break;
+	}
+
+	if (response_bounds != 0) {
+		*response_bounds = bounds;
+	}
+	return schedulable;
+}
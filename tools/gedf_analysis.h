@@ -0,0 +1,46 @@
+// Analytical schedulability tests for sporadic parallel (DAG) tasks under
+// global EDF (GEDF) on m identical cores. A task is characterized by its
+// work C (total execution time), span L (critical-path length), period T
+// and relative deadline D.
+//
+// Two sufficient tests are provided:
+// - The capacity augmentation bound test: GEDF schedules a task set if its
+//   total utilization is at most m/b and every task's span is at most D/b,
+//   with b = (3+sqrt(5))/2 (Li et al., ECRTS 2014).
+// - A response-time analysis: the response time of a task is bounded by
+//   R_k = L_k + (C_k - L_k)/m + (1/m) * sum_{i != k} I_{i,k}(R_k),
+//   where the interference of task i is the minimum of its carry-in workload
+//   bound in a window of length R_k and its workload with deadlines inside
+//   the window of length D_k that ends at task k's deadline. The response times
+//   of the interfering tasks (their slack) are refined iteratively.
+
+#ifndef GEDF_ANALYSIS_H
+#define GEDF_ANALYSIS_H
+
+#include <vector>
+#include "taskset_io.h"
+
+// Timing parameters of a DAG task used by the analyses (in nanoseconds)
+typedef struct DagTask {
+	double work;
+	double span;
+	double period;
+	double deadline;
+} DagTask;
+
+// Extract the timing parameters of the tasks read from a task set file
+std::vector<DagTask> to_dag_tasks(const std::vector<TaskSpec> &tasks);
+
+// Total utilization of the tasks
+double total_utilization(const std::vector<DagTask> &tasks);
+
+// The capacity augmentation bound test for GEDF on m cores
+bool gedf_capacity_augmentation_test(const std::vector<DagTask> &tasks, unsigned m);
+
+// The response-time test for GEDF on m cores. If @response_bounds is given,
+// it receives the response-time bound of each task; tasks that are not
+// deemed schedulable get a bound larger than their deadline.
+bool gedf_response_time_test(const std::vector<DagTask> &tasks, unsigned m,
+							 std::vector<double> *response_bounds = 0);
+
+#endif // GEDF_ANALYSIS_H
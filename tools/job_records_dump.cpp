@@ -0,0 +1,82 @@
+// This file prints binary job records (.jobs files written by task_manager
+// with RT_GOMP_JOB_RECORDS=binary) as text.
+//
+// Usage: ./job_records_dump [-H] jobs_file ...
+// For each file, a header line is printed:
+//   # <file> task <id> <FS|GEDF> period <ns> deadline <ns> jobs <n> fields <k>
+// followed, for version 2 files, by a line naming the fields:
+//   # response release start finish latency release_response tardiness
+// and one line per job with its fields separated by spaces.
+// With -H, only the header lines are printed.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <vector>
+#include "job_record.h"
+
+using namespace std;
+
+void usage(const char *program) {
+	fprintf(stderr, "Usage: %s [-H] jobs_file ...\n", program);
+}
+
+int main(int argc, char *argv[]) {
+	bool header_only = false;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "H")) != -1) {
+		switch (opt) {
+		case 'H':
+			header_only = true;
+			break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (optind >= argc) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	int ret = 0;
+	for (int i=optind; i<argc; i++) {
+		JobRecordReader reader;
+		if (!open_job_records(argv[i], reader)) {
+			fprintf(stderr, "ERROR: Cannot read job records from %s\n", argv[i]);
+			ret = 2;
+			continue;
+		}
+
+		const JobRecordHeader &header = reader.header;
+		printf("# %s task %u %s period %" PRIu64 " deadline %" PRIu64 " jobs %u fields %u\n",
+			   argv[i], header.task_id, (header.scheduler == JOB_RECORD_GEDF) ? "GEDF" : "FS",
+			   header.period, header.deadline, header.num_jobs, header.num_fields);
+
+		if (header.version >= 2 && header.num_fields >= kJobRecordFields) {
+			printf("# response release start finish latency release_response tardiness\n");
+		}
+
+		if (!header_only) {
+			vector<uint64_t> values;
+			if (!read_job_records(reader, values)) {
+				fprintf(stderr, "ERROR: Truncated job records in %s\n", argv[i]);
+				ret = 2;
+			} else {
+				for (uint32_t j=0; j<header.num_jobs; j++) {
+					for (uint32_t f=0; f<header.num_fields; f++) {
+						printf((f == 0) ? "%" PRIu64 : " %" PRIu64, values[(size_t)j*header.num_fields + f]);
+					}
+					printf("\n");
+				}
+			}
+		}
+
+		close_job_records(reader);
+	}
+
+	return ret;
+}
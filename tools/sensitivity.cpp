@@ -0,0 +1,234 @@
+// This file measures the headroom of task sets: for each task set, the largest
+// factor by which the lengths of all segments (thus the work and span of every
+// task) can be scaled while the task set stays schedulable
+//   - by FS: partition() finds enough cores for every task (with -H, a
+//     hybrid partition of partition_hybrid() is also accepted),
+//   - by GEDF on all the system cores: it passes the response-time test of
+//     gedf_analysis.h.
+// Both tests only get harder as the work and span grow, so the factor is found
+// by binary search, between 0 and the bound above which no test can pass: the
+// span of a task reaching its deadline, or the total utilization the number
+// of cores. A factor of 1.25 means the load can grow by 25% before the task
+// set must be re-provisioned; a factor below 1 means it is not schedulable now
+// and must shrink by that much.
+//
+// Usage: ./sensitivity [-j num_threads] [-e precision] [-b bin_width] [-H] {rtpt_file | directory} ...
+// A directory argument evaluates every .rtpt file in it, in parallel.
+// Output has one line per task set:
+//   <rtpt_file> <total utilization> <FS max scaling factor> <GEDF max scaling factor>
+// The last lines (starting with #) give the distribution of the factors over
+// the task sets for each scheduler: the number of schedulable task sets
+// (factor >= 1), the mean, min, percentiles and max, then a histogram with
+// one line "<bin lower bound> <FS count> <GEDF count>" per bin of @bin_width
+// (0.1 by default). The factors are exact within @precision (0.001 by default).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "taskset_io.h"
+#include "parallel_for.h"
+#include "partition.h"
+#include "gedf_analysis.h"
+
+using namespace std;
+
+// Percentiles of the factors reported in the summary
+const double kPercentiles[] = {10, 25, 50, 75, 90};
+const unsigned kNumPercentiles = sizeof(kPercentiles)/sizeof(kPercentiles[0]);
+
+// Results of a task set
+typedef struct Result {
+	bool valid; // whether the task set file could be read
+	double util;
+	double fs_factor;
+	double gedf_factor;
+} Result;
+
+// Whether FS schedules the task set with work and span scaled by @factor
+bool fs_schedulable(const vector<TaskSpec> &tasks, unsigned num_cores, bool hybrid, double factor) {
+	TaskSet ts;
+	init_taskset(tasks, ts);
+	map<unsigned, Task>::iterator it;
+	for (it = ts.taskset.begin(); it != ts.taskset.end(); it++) {
+		Task &task = it->second;
+		task.work = llround(task.work * factor);
+		task.span = llround(task.span * factor);
+		// fs_required_cores() assumes the span is shorter than the deadline
+		if (task.span >= task.deadline) return false;
+	}
+
+	if (hybrid) {
+		partition_hybrid(ts, num_cores);
+		return ts.status == PARTITION_FOUND || ts.status == PARTITION_HYBRID;
+	}
+	partition(ts, num_cores);
+	return ts.status == PARTITION_FOUND;
+}
+
+// Whether GEDF schedules the tasks with work and span scaled by @factor
+bool gedf_schedulable(const vector<DagTask> &tasks, unsigned num_cores, double factor) {
+	vector<DagTask> scaled(tasks);
+	for (unsigned i=0; i<scaled.size(); i++) {
+		scaled[i].work *= factor;
+		scaled[i].span *= factor;
+	}
+	return gedf_response_time_test(scaled, num_cores);
+}
+
+// Largest factor in [0, @max_factor] for which @schedulable holds, within
+// @precision, or 0 if it holds for none
+template <typename Test>
+double max_factor(double max_factor, double precision, Test schedulable) {
+	if (schedulable(max_factor)) return max_factor;
+
+	double low = 0, high = max_factor;
+	while (high - low > precision) {
+		double mid = (low + high)/2;
+		if (schedulable(mid)) {
+			low = mid;
+		} else {
+			high = mid;
+		}
+	}
+	return low;
+}
+
+void analyze_file(const string &rtpt_file, double precision, bool hybrid, Result &result) {
+	TaskSetSpec spec;
+	result.valid = read_rtpt(rtpt_file, spec);
+	if (!result.valid) return;
+
+	unsigned num_cores = spec.sys_last_core - spec.sys_first_core + 1;
+	vector<DagTask> tasks = to_dag_tasks(spec.tasks);
+	result.util = total_utilization(tasks);
+
+	// No task set is schedulable once a span exceeds its deadline or the
+	// utilization exceeds the number of cores
+	double bound = (result.util > 0) ? num_cores/result.util : HUGE_VAL;
+	for (unsigned i=0; i<tasks.size(); i++) {
+		if (tasks[i].span > 0) bound = min(bound, tasks[i].deadline/tasks[i].span);
+	}
+
+	const vector<TaskSpec> &task_specs = spec.tasks;
+	result.fs_factor = max_factor(bound, precision, [&](double factor) {
+		return fs_schedulable(task_specs, num_cores, hybrid, factor);
+	});
+	result.gedf_factor = max_factor(bound, precision, [&](double factor) {
+		return gedf_schedulable(tasks, num_cores, factor);
+	});
+}
+
+// Value at percentile @p of sorted values, by linear interpolation
+double percentile(const vector<double> &sorted, double p) {
+	double rank = p/100 * (sorted.size() - 1);
+	unsigned below = floor(rank);
+	if (below + 1 >= sorted.size()) return sorted.back();
+	return sorted[below] + (rank - below) * (sorted[below+1] - sorted[below]);
+}
+
+void print_distribution(const char *scheduler, vector<double> factors) {
+	sort(factors.begin(), factors.end());
+	unsigned schedulable = factors.end() - lower_bound(factors.begin(), factors.end(), 1.0);
+	double sum = 0;
+	for (unsigned i=0; i<factors.size(); i++) {
+		sum += factors[i];
+	}
+
+	printf("# %s: schedulable %u mean %.4f min %.4f", scheduler, schedulable,
+		   sum/factors.size(), factors.front());
+	for (unsigned i=0; i<kNumPercentiles; i++) {
+		printf(" p%g %.4f", kPercentiles[i], percentile(factors, kPercentiles[i]));
+	}
+	printf(" max %.4f\n", factors.back());
+}
+
+void usage(const char *program) {
+	fprintf(stderr, "Usage: %s [-j num_threads] [-e precision] [-b bin_width] [-H] {rtpt_file | directory} ...\n", program);
+}
+
+int main(int argc, char *argv[]) {
+	unsigned num_threads = 0; // use all hardware threads by default
+	double precision = 0.001;
+	double bin_width = 0.1;
+	bool hybrid = false;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "j:e:b:H")) != -1) {
+		switch (opt) {
+		case 'j':
+			num_threads = atoi(optarg);
+			break;
+		case 'e':
+			precision = atof(optarg);
+			break;
+		case 'b':
+			bin_width = atof(optarg);
+			break;
+		case 'H':
+			hybrid = true;
+			break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (optind >= argc || precision <= 0 || bin_width <= 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	vector<string> rtpt_files;
+	for (int i=optind; i<argc; i++) {
+		string path(argv[i]);
+		if (is_directory(path)) {
+			vector<string> files = list_files(path, ".rtpt");
+			rtpt_files.insert(rtpt_files.end(), files.begin(), files.end());
+		} else {
+			rtpt_files.push_back(path);
+		}
+	}
+
+	vector<Result> results(rtpt_files.size());
+	parallel_for(rtpt_files.size(), num_threads, [&](unsigned i) {
+		analyze_file(rtpt_files[i], precision, hybrid, results[i]);
+	});
+
+	// Print the results in the order of the files
+	vector<double> fs_factors, gedf_factors;
+	for (unsigned i=0; i<results.size(); i++) {
+		const Result &result = results[i];
+		if (!result.valid) continue;
+
+		fs_factors.push_back(result.fs_factor);
+		gedf_factors.push_back(result.gedf_factor);
+		printf("%s %.4f %.4f %.4f\n", rtpt_files[i].c_str(), result.util,
+			   result.fs_factor, result.gedf_factor);
+	}
+
+	printf("# Task sets: %lu\n", fs_factors.size());
+	if (!fs_factors.empty()) {
+		print_distribution(hybrid ? "FS (hybrid)" : "FS", fs_factors);
+		print_distribution("GEDF", gedf_factors);
+
+		// Histogram of the factors, up to the bin of the largest one
+		double largest = max(*max_element(fs_factors.begin(), fs_factors.end()),
+							 *max_element(gedf_factors.begin(), gedf_factors.end()));
+		unsigned num_bins = (unsigned) floor(largest/bin_width) + 1;
+		vector<unsigned> fs_bins(num_bins, 0), gedf_bins(num_bins, 0);
+		for (unsigned i=0; i<fs_factors.size(); i++) {
+			fs_bins[min((unsigned) floor(fs_factors[i]/bin_width), num_bins-1)]++;
+			gedf_bins[min((unsigned) floor(gedf_factors[i]/bin_width), num_bins-1)]++;
+		}
+		printf("# bin FS GEDF\n");
+		for (unsigned b=0; b<num_bins; b++) {
+			printf("# %.4f %u %u\n", b*bin_width, fs_bins[b], gedf_bins[b]);
+		}
+	}
+
+	return (fs_factors.size() == rtpt_files.size()) ? 0 : 2;
+}
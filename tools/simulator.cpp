@@ -0,0 +1,411 @@
+// This file simulates the execution of a task set of synthetic tasks under
+// global EDF (GEDF) and federated scheduling (FS), without running it on real cores.
+// It reads the same .rtps file as clustering_launcher_gedf/clustering_launcher_fs
+// and writes the same per-task output files as task_manager.cpp, i.e.,
+// taskN.txt for FS and taskN_gedf.txt for GEDF in the task set's output folder.
+//
+// The simulated model follows the runtime:
+// - Each job of a task runs its segments in order. The strands of a segment
+//   are executed by the task's OpenMP threads and the segment ends when all
+//   its strands finish (join).
+// - For FS, a task has one thread per core in its partition, and the strands are
+//   distributed greedily (OpenMP dynamic schedule with chunk size 1).
+// - For the tasks of the EDF pool of a hybrid partition (status 3), FS is
+//   simulated as GEDF among the pool tasks on the pool's cores.
+// - For GEDF, a task has one thread per system core, the strands are assigned
+//   to threads round-robin (OpenMP static schedule with chunk size 1), and the
+//   system cores are given to the ready threads with the earliest job deadlines.
+// - Jobs of a task are released periodically. A job that is released while the
+//   previous job is still running starts right after that job finishes.
+//   Its response time is measured from its actual start, as task_manager.cpp does.
+// - A task without any core (e.g., "2 1 97" in a heuristic partition) misses
+//   all its deadlines; its jobs are reported with response time ULONG_MAX.
+//
+// Usage: ./simulator [-s fs|gedf|both] [-q] {path_to_rtps_wo_extension | directory} ...
+// A directory argument simulates every .rtps file in it.
+// With -q, per-task output files are not written; only the summary is printed.
+// The summary has one line per task set and scheduler:
+//   <path_to_rtps_wo_extension> <FS|GEDF> <schedulable (0/1)> <total deadlines missed>
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <limits.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "taskset_io.h"
+
+using namespace std;
+
+// Whether to simulate FS, GEDF or both
+enum Sim_Scheduler {
+	SIM_FS = 1,
+	SIM_GEDF = 2,
+	SIM_BOTH = 3
+};
+
+// Simulation results of a task, in the same form as task_manager.cpp records them
+typedef struct TaskResult {
+	unsigned deadlines_missed;
+	unsigned long max_runtime;
+	unsigned long total_runtime; // total response time of all jobs but the first
+	vector<unsigned long> timings; // response time of each job
+} TaskResult;
+
+// State of the active job of a task in the GEDF simulation
+typedef struct SimJob {
+	bool active;
+	unsigned index; // job index, starting from 0
+	unsigned long release; // nominal release time
+	unsigned long deadline; // absolute deadline
+	unsigned long start; // actual start time
+	unsigned long next_activation; // when the next job of this task can start
+	unsigned segment; // the segment being executed
+	unsigned threads_left; // threads with remaining work in the current segment
+	vector<unsigned long> remaining; // remaining work of each thread in the current segment
+} SimJob;
+
+
+// Record the response time of the job with the given index
+void record_job(const TaskSpec &task, unsigned index, unsigned long runtime, TaskResult &result) {
+	result.timings[index] = runtime;
+	if (index != 0) { // abort the first job
+		if (runtime > task.deadline) result.deadlines_missed += 1;
+		if (runtime > result.max_runtime) result.max_runtime = runtime;
+		result.total_runtime += runtime;
+	}
+}
+
+void init_result(const TaskSpec &task, TaskResult &result) {
+	result.deadlines_missed = 0;
+	result.max_runtime = 0;
+	result.total_runtime = 0;
+	result.timings.assign(task.num_iters, 0);
+}
+
+// A task without any core, e.g., starved by a heuristic partition, never
+// runs: all its jobs miss their deadlines and never finish (ULONG_MAX)
+void starve_task(const TaskSpec &task, TaskResult &result) {
+	init_result(task, result);
+	result.timings.assign(task.num_iters, ULONG_MAX);
+	result.deadlines_missed = (task.num_iters > 0) ? task.num_iters - 1 : 0; // abort the first job
+	result.max_runtime = ULONG_MAX;
+}
+
+// Simulate a task on its dedicated cores.
+// With n threads that greedily take strands of equal length, a segment
+// with s strands takes ceil(s/n) rounds.
+void simulate_fs_task(const TaskSpec &task, TaskResult &result) {
+	unsigned num_threads = task.cpus.size();
+	if (num_threads == 0) {
+		starve_task(task, result);
+		return;
+	}
+	init_result(task, result);
+
+	unsigned long exec_time = 0;
+	for (unsigned i=0; i<task.segments.size(); i++) {
+		const SegmentSpec &segment = task.segments[i];
+		unsigned long rounds = (segment.num_strands + num_threads - 1) / num_threads;
+		exec_time += rounds * segment.len;
+	}
+
+	// No interference from other tasks, so every job runs for the same amount of
+	// time and a late job only delays the start of the next one.
+	for (unsigned i=0; i<task.num_iters; i++) {
+		record_job(task, i, exec_time, result);
+	}
+}
+
+// Set up the per-thread work of the current segment of a job.
+// Strand j of a segment is run by thread (j % m). Empty segments are skipped.
+void load_segment(const TaskSpec &task, unsigned num_threads, SimJob &job) {
+	job.threads_left = 0;
+	while (job.segment < task.segments.size()) {
+		const SegmentSpec &segment = task.segments[job.segment];
+		unsigned base = segment.num_strands / num_threads;
+		unsigned extra = segment.num_strands % num_threads;
+		for (unsigned t=0; t<num_threads; t++) {
+			unsigned strands = base + (t < extra ? 1 : 0);
+			job.remaining[t] = strands * segment.len;
+			if (job.remaining[t] > 0) job.threads_left++;
+		}
+
+		if (job.threads_left > 0) return;
+		job.segment++;
+	}
+}
+
+// Order active jobs by absolute deadline, breaking ties by task id
+typedef struct JobOrder {
+	const vector<SimJob> *jobs;
+	bool operator()(unsigned a, unsigned b) const {
+		const SimJob &ja = (*jobs)[a];
+		const SimJob &jb = (*jobs)[b];
+		if (ja.deadline != jb.deadline) return ja.deadline < jb.deadline;
+		return a < b;
+	}
+} JobOrder;
+
+// Simulate the whole task set under global EDF on the system cores
+void simulate_gedf(const TaskSetSpec &ts, vector<TaskResult> &results) {
+	unsigned num_tasks = ts.tasks.size();
+	unsigned num_cores = ts.sys_last_core - ts.sys_first_core + 1;
+
+	results.resize(num_tasks);
+	if (num_cores == 0) {
+		for (unsigned i=0; i<num_tasks; i++) {
+			starve_task(ts.tasks[i], results[i]);
+		}
+		return;
+	}
+
+	vector<SimJob> jobs(num_tasks);
+	for (unsigned i=0; i<num_tasks; i++) {
+		const TaskSpec &task = ts.tasks[i];
+		init_result(task, results[i]);
+		jobs[i].active = false;
+		jobs[i].index = 0;
+		jobs[i].remaining.assign(num_cores, 0);
+		jobs[i].next_activation = (task.num_iters > 0) ? task.release : ULONG_MAX;
+	}
+
+	// Threads that hold a core in the current interval: <task index, thread index>
+	vector<pair<unsigned, unsigned> > running;
+	running.reserve(num_cores);
+	vector<unsigned> order;
+	order.reserve(num_tasks);
+	JobOrder job_order;
+	job_order.jobs = &jobs;
+
+	unsigned long now = 0;
+	while (true) {
+		// Activate the jobs that can start now
+		unsigned long next_activation = ULONG_MAX;
+		for (unsigned i=0; i<num_tasks; i++) {
+			SimJob &job = jobs[i];
+			if (!job.active && job.next_activation <= now) {
+				const TaskSpec &task = ts.tasks[i];
+				job.active = true;
+				job.release = task.release + (unsigned long)job.index * task.period;
+				job.deadline = job.release + task.deadline;
+				job.start = now;
+				job.segment = 0;
+				load_segment(task, num_cores, job);
+				job.next_activation = ULONG_MAX;
+			}
+			if (!job.active && job.next_activation < next_activation) {
+				next_activation = job.next_activation;
+			}
+		}
+
+		// Give the cores to the threads of the earliest-deadline jobs
+		order.clear();
+		for (unsigned i=0; i<num_tasks; i++) {
+			if (jobs[i].active) order.push_back(i);
+		}
+
+		if (order.empty()) {
+			if (next_activation == ULONG_MAX) break; // all jobs are done
+			now = next_activation;
+			continue;
+		}
+
+		sort(order.begin(), order.end(), job_order);
+		running.clear();
+		unsigned long step = ULONG_MAX;
+		for (unsigned k=0; k<order.size() && running.size() < num_cores; k++) {
+			SimJob &job = jobs[order[k]];
+			for (unsigned t=0; t<num_cores && running.size() < num_cores; t++) {
+				if (job.remaining[t] == 0) continue;
+				running.push_back(make_pair(order[k], t));
+				if (job.remaining[t] < step) step = job.remaining[t];
+			}
+		}
+
+		// Run until a thread finishes its strands or a new job arrives.
+		// Jobs without any work left finish right away.
+		if (running.empty()) step = 0;
+		else if (next_activation - now < step) step = next_activation - now;
+		for (unsigned k=0; k<running.size(); k++) {
+			SimJob &job = jobs[running[k].first];
+			unsigned long &remaining = job.remaining[running[k].second];
+			remaining -= step;
+			if (remaining == 0) job.threads_left--;
+		}
+		now += step;
+
+		// Move finished segments (join) to the next segment, and finish jobs
+		for (unsigned k=0; k<order.size(); k++) {
+			unsigned i = order[k];
+			SimJob &job = jobs[i];
+			if (job.threads_left > 0) continue;
+
+			const TaskSpec &task = ts.tasks[i];
+			job.segment++;
+			load_segment(task, num_cores, job);
+			if (job.segment < task.segments.size()) continue;
+
+			record_job(task, job.index, now - job.start, results[i]);
+			job.active = false;
+			job.index++;
+			if (job.index < task.num_iters) {
+				unsigned long release = task.release + (unsigned long)job.index * task.period;
+				job.next_activation = max(release, now);
+			}
+		}
+	}
+}
+
+// Write the results of a task in the same format as task_manager.cpp
+bool write_task_output(const string &file_name, const TaskSpec &task, const TaskResult &result) {
+	FILE *fp = fopen(file_name.c_str(), "w");
+	if (fp == NULL) {
+		fprintf(stderr, "ERROR: Cannot open output file %s\n", file_name.c_str());
+		return false;
+	}
+
+	const char *task_name = task.program_name.c_str();
+	unsigned num_iters = task.num_iters;
+	uint64_t avg = (num_iters > 1) ? result.total_runtime/(num_iters-1) : 0;
+	if (result.max_runtime == ULONG_MAX) avg = ULONG_MAX; // jobs that never finish
+	fprintf(fp, "Deadlines missed for task %s: %d/%d\n", task_name, result.deadlines_missed, num_iters);
+	fprintf(fp, "Max running time for task %s: %lu sec  %lu nsec\n", task_name,
+			result.max_runtime/kNsecPerSec, result.max_runtime%kNsecPerSec);
+	fprintf(fp, "Avg running time for task %s: %" PRIu64 " nsec\n", task_name, avg);
+
+	for (unsigned i=0; i<num_iters; i++) {
+		fprintf(fp, "%lu\n", result.timings[i]);
+	}
+
+	fclose(fp);
+	return true;
+}
+
+// Write the output files of all tasks and print the summary line for a scheduler
+void report(const string &base, const TaskSetSpec &ts, const vector<TaskResult> &results,
+			const char *sched_name, const char *tail, bool write_outputs) {
+	unsigned long total_missed = 0;
+	string out_folder = base + "_output";
+	if (write_outputs && !make_dir(out_folder)) {
+		write_outputs = false;
+	}
+
+	for (unsigned i=0; i<ts.tasks.size(); i++) {
+		total_missed += results[i].deadlines_missed;
+		if (write_outputs) {
+			char file_name[32];
+			snprintf(file_name, sizeof(file_name), "/task%u%s.txt", i+1, tail);
+			write_task_output(out_folder + file_name, ts.tasks[i], results[i]);
+		}
+	}
+
+	printf("%s %s %d %lu\n", base.c_str(), sched_name, (total_missed == 0) ? 1 : 0, total_missed);
+}
+
+// Simulate a task set. @base is the path to the .rtps file without extension.
+bool simulate_taskset(const string &base, unsigned schedulers, bool write_outputs) {
+	TaskSetSpec ts;
+	if (!read_rtps(base + ".rtps", ts)) {
+		return false;
+	}
+
+	// Like the launchers, do not run task sets whose total utilization
+	// is larger than the number of cores.
+	if (ts.status == 2) {
+		fprintf(stderr, "WARNING: Taskset NOT schedulable with FS: %s\n", base.c_str());
+		return true;
+	}
+
+	vector<TaskResult> results;
+	if (schedulers & SIM_FS) {
+		results.resize(ts.tasks.size());
+		TaskSetSpec pool;
+		vector<unsigned> pool_tasks;
+		for (unsigned i=0; i<ts.tasks.size(); i++) {
+			if (ts.tasks[i].edf_pool) {
+				pool.tasks.push_back(ts.tasks[i]);
+				pool_tasks.push_back(i);
+			} else {
+				simulate_fs_task(ts.tasks[i], results[i]);
+			}
+		}
+
+		// The pool tasks share the same CPUs, numbered from 1 so that a pool
+		// without CPU has no core
+		if (!pool.tasks.empty()) {
+			vector<TaskResult> pool_results;
+			pool.sys_first_core = 1;
+			pool.sys_last_core = pool.tasks[0].cpus.size();
+			simulate_gedf(pool, pool_results);
+			for (unsigned k=0; k<pool_tasks.size(); k++) {
+				results[pool_tasks[k]] = pool_results[k];
+			}
+		}
+		report(base, ts, results, "FS", "", write_outputs);
+	}
+
+	if (schedulers & SIM_GEDF) {
+		simulate_gedf(ts, results);
+		report(base, ts, results, "GEDF", "_gedf", write_outputs);
+	}
+
+	return true;
+}
+
+void usage(const char *program) {
+	fprintf(stderr, "Usage: %s [-s fs|gedf|both] [-q] {path_to_rtps_wo_extension | directory} ...\n", program);
+}
+
+int main(int argc, char *argv[]) {
+	unsigned schedulers = SIM_BOTH;
+	bool write_outputs = true;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "s:q")) != -1) {
+		switch (opt) {
+		case 's':
+			if (string(optarg) == "fs") schedulers = SIM_FS;
+			else if (string(optarg) == "gedf") schedulers = SIM_GEDF;
+			else if (string(optarg) == "both") schedulers = SIM_BOTH;
+			else {
+				fprintf(stderr, "ERROR: Unknown scheduler %s\n", optarg);
+				return 1;
+			}
+			break;
+		case 'q':
+			write_outputs = false;
+			break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (optind >= argc) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	int ret = 0;
+	for (int i=optind; i<argc; i++) {
+		string path(argv[i]);
+		vector<string> bases;
+		if (is_directory(path)) {
+			vector<string> files = list_files(path, ".rtps");
+			for (unsigned j=0; j<files.size(); j++) {
+				bases.push_back(files[j].substr(0, files[j].size() - 5));
+			}
+		} else {
+			bases.push_back(path);
+		}
+
+		for (unsigned j=0; j<bases.size(); j++) {
+			if (!simulate_taskset(bases[j], schedulers, write_outputs)) ret = 2;
+		}
+	}
+
+	return ret;
+}
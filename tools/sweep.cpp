@@ -0,0 +1,292 @@
+// This file sweeps a grid of task set parameters for GEDF vs. FS experiments.
+// For every cell of the grid (number of cores, number of tasks, normalized
+// utilization, and normalized utilization lost or parallelism range), it
+// generates task sets in parallel as taskset_gen does, evaluates them
+// analytically as analyze does, and appends the acceptance ratios of the
+// cell to the results file as soon as the cell is done.
+//
+// Usage: ./sweep [-c count] [-s seed] [-j num_threads] [-o results_file] [-d folder] [-w workload]
+//                [-m cores] [-n num_tasks] [-u norm_utils] [-l norm_utils_lost | -p para_ranges]
+// Each grid axis is a comma-separated list of values or ranges <first>:<last>:<step>,
+// e.g., -n 1:5 -u 0.1:0.9:0.1,0.95 (the step is 1 by default). The parallelism
+// ranges are <low>_<high> pairs, e.g., -p 10_20,35_45. The type of experiment
+// is selected as in taskset_gen: varying utilization lost with -l, varying
+// parallelism with -p, and varying number of tasks otherwise. The defaults are
+// -c 100 -m 16 -n 1:5 -u 0.75, the grid of gen.sh.
+// Cells for which no task set can be generated (see init_config) are skipped.
+// With -d, the task sets are also written to .rtpt files in the folders of
+// taskset_gen under @folder, on the cores 0 to m-1, so that they can be
+// partitioned and run afterwards.
+//
+// The results file (the standard output by default) has one line per cell:
+//   <cores> <tasks> <util> <lost> <para_low> <para_high> <task sets> <FS> <FS hybrid> <GEDF capacity> <GEDF RTA>
+// where the last four columns are the fractions of the task sets for which
+// partition() finds a partition (status 0), partition_hybrid() finds a
+// partition or a hybrid one (status 0 or 3), and the GEDF capacity
+// augmentation and response-time tests pass. The lost and parallelism
+// columns are 0 when they are not an axis of the experiment.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <algorithm>
+#include "taskset_io.h"
+#include "parallel_for.h"
+#include "workload.h"
+#include "partition.h"
+#include "gedf_analysis.h"
+#include "taskset_generator.h"
+
+using namespace std;
+
+// Values of the grid are rounded to this many decimals, so that the ranges
+// give the same folder names as the values written by hand
+const double kGridResolution = 1e9;
+
+// Analysis results of a task set
+typedef struct Result {
+	bool written; // whether the task set could be written, with -d
+	bool fs;
+	bool fs_hybrid;
+	bool gedf_capacity;
+	bool gedf_rta;
+} Result;
+
+// Parse a grid axis: a comma-separated list of values or ranges first:last[:step].
+// Return false if it is malformed.
+bool parse_axis(const string &axis, vector<double> &values) {
+	values.clear();
+	stringstream axis_stream(axis);
+	string item;
+	while (getline(axis_stream, item, ',')) {
+		double first, last, step = 1;
+		char sep1, sep2;
+		istringstream item_stream(item);
+		if (!(item_stream >> first)) return false;
+		if (item_stream >> sep1) {
+			if (sep1 != ':' || !(item_stream >> last)) return false;
+			if (item_stream >> sep2 && (sep2 != ':' || !(item_stream >> step))) return false;
+			if (step <= 0 || last < first) return false;
+		} else {
+			last = first;
+		}
+
+		for (unsigned k=0; first + k*step <= last + step/kGridResolution; k++) {
+			values.push_back(round((first + k*step)*kGridResolution)/kGridResolution);
+		}
+	}
+	return !values.empty();
+}
+
+// Parse a grid axis of positive integers
+bool parse_int_axis(const string &axis, vector<unsigned> &values) {
+	vector<double> doubles;
+	if (!parse_axis(axis, doubles)) return false;
+	values.clear();
+	for (unsigned i=0; i<doubles.size(); i++) {
+		if (doubles[i] < 1 || doubles[i] != floor(doubles[i])) return false;
+		values.push_back((unsigned)doubles[i]);
+	}
+	return true;
+}
+
+// Parse the parallelism ranges: a comma-separated list of low_high pairs
+bool parse_para_ranges(const string &axis, vector<pair<unsigned, unsigned> > &ranges) {
+	stringstream axis_stream(axis);
+	string item;
+	while (getline(axis_stream, item, ',')) {
+		unsigned low, high;
+		if (sscanf(item.c_str(), "%u_%u", &low, &high) != 2 || low >= high) return false;
+		ranges.push_back(make_pair(low, high));
+	}
+	return !ranges.empty();
+}
+
+void analyze_taskset(const vector<GenTask> &taskset, unsigned num_cores, Result &result) {
+	vector<TaskSpec> task_specs = to_task_specs(taskset);
+	vector<DagTask> tasks = to_dag_tasks(task_specs);
+
+	TaskSet ts;
+	init_taskset(task_specs, ts);
+	partition(ts, num_cores);
+	result.fs = (ts.status == PARTITION_FOUND);
+
+	init_taskset(task_specs, ts);
+	partition_hybrid(ts, num_cores);
+	result.fs_hybrid = (ts.status == PARTITION_FOUND || ts.status == PARTITION_HYBRID);
+
+	result.gedf_capacity = gedf_capacity_augmentation_test(tasks, num_cores);
+	result.gedf_rta = gedf_response_time_test(tasks, num_cores);
+}
+
+void usage(const char *program) {
+	fprintf(stderr, "Usage: %s [-c count] [-s seed] [-j num_threads] [-o results_file] [-d folder] [-w workload]\n"
+			"       [-m cores] [-n num_tasks] [-u norm_utils] [-l norm_utils_lost | -p para_ranges]\n", program);
+}
+
+int main(int argc, char *argv[]) {
+	unsigned count = 100;
+	unsigned long seed = 1;
+	unsigned num_threads = 0; // use all hardware threads by default
+	string results_file, folder, workload;
+	Experiment_Type type = VARYING_NUM_TASKS;
+
+	vector<unsigned> cores(1, 16), num_tasks;
+	vector<double> utils(1, 0.75), utils_lost(1, 0);
+	vector<pair<unsigned, unsigned> > para_ranges(1, make_pair(0, 0));
+	for (unsigned n=1; n<=5; n++) {
+		num_tasks.push_back(n);
+	}
+
+	int opt;
+	bool valid = true;
+	while ((opt = getopt(argc, argv, "c:s:j:o:d:w:m:n:u:l:p:")) != -1) {
+		switch (opt) {
+		case 'c':
+			count = atoi(optarg);
+			break;
+		case 's':
+			seed = strtoul(optarg, NULL, 10);
+			break;
+		case 'j':
+			num_threads = atoi(optarg);
+			break;
+		case 'o':
+			results_file = optarg;
+			break;
+		case 'd':
+			folder = optarg;
+			break;
+		case 'w': {
+			WorkloadSpec spec;
+			if (!parse_workload(optarg, spec)) {
+				fprintf(stderr, "ERROR: Unknown workload %s\n", optarg);
+				return 1;
+			}
+			workload = optarg;
+			break;
+		}
+		case 'm':
+			valid = valid && parse_int_axis(optarg, cores);
+			break;
+		case 'n':
+			valid = valid && parse_int_axis(optarg, num_tasks);
+			break;
+		case 'u':
+			valid = valid && parse_axis(optarg, utils);
+			break;
+		case 'l':
+			valid = valid && parse_axis(optarg, utils_lost) && type != VARYING_PARALLELISM;
+			type = VARYING_UTIL_LOST;
+			break;
+		case 'p':
+			para_ranges.clear();
+			valid = valid && parse_para_ranges(optarg, para_ranges) && type != VARYING_UTIL_LOST;
+			type = VARYING_PARALLELISM;
+			break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (!valid || optind != argc || count == 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	FILE *out = stdout;
+	if (!results_file.empty()) {
+		out = fopen(results_file.c_str(), "w");
+		if (out == NULL) {
+			fprintf(stderr, "ERROR: Cannot open file %s\n", results_file.c_str());
+			return 1;
+		}
+	}
+	if (!folder.empty() && !make_dir(folder)) {
+		return 1;
+	}
+
+	fprintf(out, "# cores tasks util lost para_low para_high tasksets fs fs_hybrid gedf_capacity gedf_rta\n");
+	fflush(out);
+
+	unsigned num_cells = 0, num_failed = 0;
+	for (unsigned a=0; a<cores.size(); a++)
+	for (unsigned b=0; b<num_tasks.size(); b++)
+	for (unsigned c=0; c<utils.size(); c++)
+	for (unsigned d=0; d<utils_lost.size(); d++)
+	for (unsigned e=0; e<para_ranges.size(); e++) {
+		Config config;
+		config.type = type;
+		config.m = cores[a];
+		config.num_tasks = num_tasks[b];
+		config.norm_util = utils[c];
+		config.norm_util_lost = utils_lost[d];
+		config.para_low = para_ranges[e].first;
+		config.para_high = para_ranges[e].second;
+
+		const char *error = init_config(config);
+		if (error != NULL) {
+			fprintf(out, "# %u %u %g %g %u %u skipped: %s\n", config.m, config.num_tasks, config.norm_util,
+					config.norm_util_lost, config.para_low, config.para_high, error);
+			fflush(out);
+			continue;
+		}
+
+		// Number the new files after the existing ones
+		string directory;
+		unsigned first_number = 1;
+		if (!folder.empty()) {
+			directory = taskset_directory(folder, config);
+			if (!make_dir(directory)) {
+				num_failed++;
+				continue;
+			}
+			first_number = list_files(directory, ".rtpt").size() + 1;
+		}
+
+		// Each task set has its own random stream derived from the seed, the
+		// cell and the task set's number, as in taskset_gen
+		vector<Result> results(count);
+		parallel_for(count, num_threads, [&](unsigned i) {
+			unsigned number = first_number + i;
+			seed_seq seq = {(unsigned)seed, (unsigned)(seed >> 32), config.m, config.num_tasks,
+							(unsigned)llround(config.norm_util*1e6), (unsigned)llround(config.norm_util_lost*1e6),
+							config.para_low, config.para_high, number};
+			Rng rng(seq);
+
+			vector<GenTask> taskset = taskset_generate(config, rng);
+			results[i].written = true;
+			if (!directory.empty()) {
+				string file_name = directory + "/taskset" + to_string(number) + ".rtpt";
+				results[i].written = write_rtpt(taskset, 0, config.m - 1, workload, file_name);
+			}
+			analyze_taskset(taskset, config.m, results[i]);
+		});
+
+		unsigned fs = 0, fs_hybrid = 0, capacity = 0, rta = 0;
+		for (unsigned i=0; i<count; i++) {
+			if (!results[i].written) num_failed++;
+			if (results[i].fs) fs++;
+			if (results[i].fs_hybrid) fs_hybrid++;
+			if (results[i].gedf_capacity) capacity++;
+			if (results[i].gedf_rta) rta++;
+		}
+
+		fprintf(out, "%u %u %g %g %u %u %u %.4f %.4f %.4f %.4f\n", config.m, config.num_tasks, config.norm_util,
+				config.norm_util_lost, config.para_low, config.para_high, count,
+				(double)fs/count, (double)fs_hybrid/count, (double)capacity/count, (double)rta/count);
+		fflush(out);
+		num_cells++;
+	}
+
+	if (out != stdout) {
+		fclose(out);
+	}
+	fprintf(stderr, "Evaluated %u cells of %u task sets\n", num_cells, count);
+	return (num_failed == 0) ? 0 : 2;
+}
@@ -0,0 +1,140 @@
+// This file generates task sets for GEDF vs. FS experiments, like taskset_generate.py,
+// and writes them to .rtpt files in the same format as its write_to_rtpt().
+// Tasks are independent (i.e., there is no shared resource in this work).
+//
+// Usage: ./taskset_gen [-c count] [-s seed] [-j num_threads] [-p para_low,para_high] [-d folder]
+//                      [-w workload] <sys_first_core> <sys_last_core> <num_tasks> <total_util_frac> [total_util_lost_frac]
+// It generates @count task sets (default 1) in parallel and writes them to
+// <folder>/core=<m>n=<num_tasks>util=<total_util_frac>[para=<low>_<high>][lost=<total_util_lost_frac>]
+// (<folder> is "data" by default), numbering the files after the existing .rtpt files.
+// The type of experiment is selected by the arguments:
+// - with total_util_lost_frac: varying total utilization lost (main_varying_util_lost),
+// - with -p: varying parallelism (main_varying_parallelism),
+// - otherwise: varying number of tasks (main_varying_num_tasks).
+// Each task set has its own random stream derived from the seed and the task set's
+// number, so the output does not depend on the number of threads.
+// With -w, every segment runs the given workload (see workload.h), e.g., -w chase:8M.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "taskset_io.h"
+#include "parallel_for.h"
+#include "workload.h"
+#include "taskset_generator.h"
+
+using namespace std;
+
+void usage(const char *program) {
+	fprintf(stderr, "Usage: %s [-c count] [-s seed] [-j num_threads] [-p para_low,para_high] [-d folder] [-w workload]\n"
+			"       <sys_first_core> <sys_last_core> <num_tasks> <total_util_frac> [total_util_lost_frac]\n", program);
+}
+
+int main(int argc, char *argv[]) {
+	unsigned count = 1;
+	unsigned long seed = 1;
+	unsigned num_threads = 0; // use all hardware threads by default
+	string folder = "data";
+	string workload;
+
+	Config config;
+	config.type = VARYING_NUM_TASKS;
+	config.norm_util_lost = 0;
+	config.para_low = 0;
+	config.para_high = 0;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "c:s:j:p:d:w:")) != -1) {
+		switch (opt) {
+		case 'c':
+			count = atoi(optarg);
+			break;
+		case 's':
+			seed = strtoul(optarg, NULL, 10);
+			break;
+		case 'j':
+			num_threads = atoi(optarg);
+			break;
+		case 'p':
+			if (sscanf(optarg, "%u,%u", &config.para_low, &config.para_high) != 2 ||
+				config.para_low >= config.para_high) {
+				usage(argv[0]);
+				return 1;
+			}
+			config.type = VARYING_PARALLELISM;
+			break;
+		case 'd':
+			folder = optarg;
+			break;
+		case 'w': {
+			WorkloadSpec spec;
+			if (!parse_workload(optarg, spec)) {
+				fprintf(stderr, "ERROR: Unknown workload %s\n", optarg);
+				return 1;
+			}
+			workload = optarg;
+			break;
+		}
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	int num_args = argc - optind;
+	if (num_args != 4 && num_args != 5) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	unsigned sys_first_core = atoi(argv[optind]);
+	unsigned sys_last_core = atoi(argv[optind+1]);
+	if (sys_last_core < sys_first_core) {
+		fprintf(stderr, "Incorrect system core range!\n");
+		return 1;
+	}
+	config.num_tasks = atoi(argv[optind+2]);
+	config.norm_util = atof(argv[optind+3]);
+	config.m = sys_last_core - sys_first_core + 1;
+
+	if (num_args == 5) {
+		if (config.type == VARYING_PARALLELISM) {
+			fprintf(stderr, "ERROR: Utilization lost and parallelism range cannot be used together!\n");
+			return 1;
+		}
+		config.type = VARYING_UTIL_LOST;
+		config.norm_util_lost = atof(argv[optind+4]);
+	}
+
+	const char *error = init_config(config);
+	if (error != NULL) {
+		fprintf(stderr, "ERROR: %s!\n", error);
+		return 1;
+	}
+	string directory = taskset_directory(folder, config);
+
+	if (!make_dir(folder) || !make_dir(directory)) {
+		return 1;
+	}
+
+	// Number the new files after the existing ones
+	unsigned first_number = list_files(directory, ".rtpt").size() + 1;
+
+	vector<char> written(count, 0);
+	parallel_for(count, num_threads, [&](unsigned i) {
+		unsigned number = first_number + i;
+		seed_seq seq = {(unsigned)seed, (unsigned)(seed >> 32), number};
+		Rng rng(seq);
+
+		vector<GenTask> taskset = taskset_generate(config, rng);
+		string file_name = directory + "/taskset" + to_string(number) + ".rtpt";
+		written[i] = write_rtpt(taskset, sys_first_core, sys_last_core, workload, file_name);
+	});
+
+	unsigned num_written = std::count(written.begin(), written.end(), 1);
+	fprintf(stderr, "Generated %u task sets in %s\n", num_written, directory.c_str());
+	return (num_written == count) ? 0 : 2;
+}
@@ -0,0 +1,407 @@
+// Random generation of task sets. See taskset_generator.h.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include "taskset_generator.h"
+
+using namespace std;
+
+// One microsecond is a thousand nanoseconds
+const unsigned long kNsecPerUsec = 1000;
+
+// Min and max exponent of period (base 2). The obtained period's unit is microsecond.
+const int kPeriodMinExpo = 13;
+const int kPeriodMaxExpo = 20;
+
+// Number of hyper-period we want the task set to run
+const unsigned kNumHyperPeriod = 100;
+
+// Ratio between span and period is excpercent times one of the choices
+const double kExcPercent = 0.25;
+const double kChoice[] = {0.5, 0.5, 0.5, 0.5, 0.65, 0.65, 0.65, 0.75, 0.75, 1};
+
+// Give up generating a non-zero segment length after this many tries
+const unsigned kMaxSegmentTries = 10000;
+
+static double uniform(Rng &rng, double low, double high) {
+	return uniform_real_distribution<double>(low, high)(rng);
+}
+
+// Return a random integer in [low, high], both inclusive
+static int randint(Rng &rng, int low, int high) {
+	return uniform_int_distribution<int>(low, high)(rng);
+}
+
+// Roger Stafford's randfixedsum algorithm, for a single set (see taskgen.py).
+// Return n values in [0, 1] that sum up to u.
+static vector<double> stafford_rand_fixed_sum(unsigned n, double u, Rng &rng) {
+	if (n == 1) return vector<double>(1, u);
+
+	double k = floor(u);
+	vector<double> s1(n), s2(n);
+	for (unsigned i=0; i<n; i++) {
+		s1[i] = u - (k - i);
+		s2[i] = (k + n - i) - u;
+	}
+
+	const double tiny = DBL_MIN;
+	const double huge = DBL_MAX;
+	vector<vector<double> > w(n, vector<double>(n+1, 0));
+	vector<vector<double> > t(n-1, vector<double>(n, 0));
+	w[0][1] = huge;
+
+	for (unsigned i=2; i<=n; i++) {
+		for (unsigned j=0; j<i; j++) {
+			double tmp1 = w[i-2][j+1] * s1[j]/i;
+			double tmp2 = w[i-2][j] * s2[n-i+j]/i;
+			w[i-1][j+1] = tmp1 + tmp2;
+			double tmp3 = w[i-1][j+1] + tiny;
+			if (s2[n-i+j] > s1[j]) {
+				t[i-2][j] = tmp2/tmp3;
+			} else {
+				t[i-2][j] = 1 - tmp1/tmp3;
+			}
+		}
+	}
+
+	vector<double> x(n, 0);
+	double s = u;
+	int j = (int)k + 1;
+	double sm = 0, pr = 1;
+	for (unsigned i=n-1; i>=1; i--) {
+		double rt = uniform(rng, 0, 1); // rand simplex type
+		double rs = uniform(rng, 0, 1); // rand position in simplex
+		int e = (rt <= t[i-1][j-1]) ? 1 : 0; // decide which direction to move in this dimension
+		double sx = pow(rs, 1.0/i); // next simplex coord
+		sm = sm + (1-sx) * pr * s/(i+1);
+		pr = sx * pr;
+		x[n-i-1] = sm + pr * e;
+		s = s - e;
+		j = j - e;
+	}
+	x[n-1] = sm + pr * s;
+
+	// Iterated in fixed dimension order but needs to be randomised
+	shuffle(x.begin(), x.end(), rng);
+	return x;
+}
+
+// Generate the tasks' utilizations in [util_min, util_max] that sum up to (norm_util * m)
+static vector<double> generate_tasks_utils(const Config &config, Rng &rng) {
+	double lower = config.util_min;
+	double upper = config.util_max;
+	double u = config.norm_util * config.m;
+
+	vector<double> x = stafford_rand_fixed_sum(config.num_tasks, (u - config.num_tasks*lower)/(upper - lower), rng);
+	for (unsigned i=0; i<x.size(); i++) {
+		x[i] = x[i]*(upper - lower) + lower;
+	}
+	return x;
+}
+
+// Generate period in nanosecond
+static unsigned long period_generate(Rng &rng) {
+	unsigned long period_us = 1UL << randint(rng, kPeriodMinExpo, kPeriodMaxExpo);
+	return period_us * kNsecPerUsec;
+}
+
+// Generate segment length in nanosecond, relative to the span
+static unsigned long threadtype_generate(unsigned long span, Rng &rng) {
+	double temp = floor(lognormal_distribution<double>(0.6, 3)(rng) + 5);
+	return 1000 * (unsigned long)floor(span/(temp*1000));
+}
+
+// Generate the program structure of a task with the expected work and span.
+// The span is made up of segments with lengths from threadtype_generate(),
+// then strands are added to random segments until the work is reached.
+static GenTask program_generate(unsigned long period, unsigned long expected_work, unsigned long expected_span, Rng &rng) {
+	GenTask task;
+	task.period = period;
+
+	unsigned long sumtime = 0;
+	unsigned long sumwork = 0;
+
+	// First, generate a list of segment lengths that makes up the span
+	while (sumtime < expected_span) {
+		unsigned long seglength = threadtype_generate(expected_span, rng);
+		unsigned tries = 0;
+		while (((sumtime + seglength) > expected_span && sumtime == 0) || seglength == 0) {
+			if (++tries > kMaxSegmentTries) {
+				seglength = expected_span - sumtime;
+				break;
+			}
+			seglength = threadtype_generate(expected_span, rng);
+		}
+		if ((sumtime + seglength) > expected_span) {
+			seglength = expected_span - sumtime;
+		}
+
+		Segment segment;
+		segment.id = task.program.size() + 1;
+		segment.num_strands = 1;
+		segment.len = seglength;
+		task.program.push_back(segment);
+
+		sumtime += seglength;
+		sumwork += seglength;
+	}
+
+	// Segments sorted by increasing length
+	vector<Segment> sorted_segments(task.program);
+	sort(sorted_segments.begin(), sorted_segments.end(),
+		 [](const Segment &a, const Segment &b) { return a.len < b.len; });
+
+	// Then iteratively add strands until it adds up to work (approximately)
+	while (sumwork < expected_work && !task.program.empty()) {
+		Segment &seg = task.program[randint(rng, 0, task.program.size() - 1)];
+		if (sumwork + seg.len <= expected_work) {
+			seg.num_strands += 1;
+			sumwork += seg.len;
+		} else {
+			// Find the last strand that can be added to the program
+			int last_segid = -1;
+			for (unsigned i=0; i<sorted_segments.size(); i++) {
+				if (sumwork + sorted_segments[i].len <= expected_work) {
+					last_segid = sorted_segments[i].id;
+				} else {
+					break;
+				}
+			}
+			if (last_segid != -1) {
+				task.program[last_segid-1].num_strands += 1;
+				sumwork += task.program[last_segid-1].len;
+			}
+			break;
+		}
+	}
+
+	return task;
+}
+
+// Generate a task's parameters: period, work, span, with span/period from the choices
+static void parameters_gen_basic(double util, Rng &rng, unsigned long &period, unsigned long &work, unsigned long &span) {
+	period = period_generate(rng);
+	work = (unsigned long)(period * util);
+	double excp = kExcPercent * kChoice[randint(rng, 0, sizeof(kChoice)/sizeof(kChoice[0]) - 1)];
+	span = (unsigned long)(excp * period);
+}
+
+// Generate a task's parameters with the parallelism drawn from [para_low, para_high)
+static void parameters_gen_varying_parallelism(double util, const Config &config, Rng &rng,
+										unsigned long &period, unsigned long &work, unsigned long &span) {
+	period = period_generate(rng);
+	double parallelism = uniform(rng, config.para_low, config.para_high);
+	work = (unsigned long)(period * util);
+	span = (unsigned long)(work/parallelism);
+}
+
+// Generate a task's parameters so that FS requires exactly @num_cores cores for it
+static void parameters_gen_varying_util_lost(double util, unsigned num_cores, Rng &rng,
+									  unsigned long &period, unsigned long &work, unsigned long &span) {
+	period = period_generate(rng);
+	work = (unsigned long)(period * util);
+	double ratio = (max((double)(num_cores - 1), util) + num_cores)/2;
+	span = (unsigned long)((ratio*period - work)/(ratio - 1));
+}
+
+// Generate a task set for the configured experiment
+vector<GenTask> taskset_generate(const Config &config, Rng &rng) {
+	vector<double> utils;
+	vector<unsigned> cores_to_tasks;
+
+	if (config.type == VARYING_UTIL_LOST) {
+		double u = config.m * config.norm_util;
+		double u_lost = config.m * config.norm_util_lost;
+
+		// Regenerate the utilizations until the sum of their ceilings fits
+		// in the number of cores required by FS
+		double total_ceil_util;
+		do {
+			utils = generate_tasks_utils(config, rng);
+			total_ceil_util = 0;
+			for (unsigned i=0; i<utils.size(); i++) {
+				total_ceil_util += ceil(utils[i]);
+			}
+		} while (total_ceil_util > u + u_lost);
+
+		// Init the number of cores of each task to the ceiling of its utilization,
+		// then allocate the spare cores to the tasks in a random manner
+		for (unsigned i=0; i<utils.size(); i++) {
+			cores_to_tasks.push_back((unsigned)ceil(utils[i]));
+		}
+		double spare_cores = (u + u_lost) - total_ceil_util;
+		while (spare_cores > 0) {
+			cores_to_tasks[randint(rng, 0, config.num_tasks - 1)] += 1;
+			spare_cores -= 1;
+		}
+	} else {
+		utils = generate_tasks_utils(config, rng);
+	}
+
+	vector<GenTask> taskset;
+	for (unsigned i=0; i<utils.size(); i++) {
+		unsigned long period, work, span;
+		if (config.type == VARYING_UTIL_LOST) {
+			parameters_gen_varying_util_lost(utils[i], cores_to_tasks[i], rng, period, work, span);
+		} else if (config.type == VARYING_PARALLELISM) {
+			parameters_gen_varying_parallelism(utils[i], config, rng, period, work, span);
+		} else {
+			parameters_gen_basic(utils[i], rng, period, work, span);
+		}
+		taskset.push_back(program_generate(period, work, span, rng));
+	}
+
+	return taskset;
+}
+
+// Convert a time duration in nanoseconds to "sec nsec", as convert_nsec_to_timespec() does
+static string timespec_string(unsigned long length) {
+	char buf[64];
+	if (length > kNsecPerSec) {
+		snprintf(buf, sizeof(buf), "%lu %lu", length/kNsecPerSec, length%kNsecPerSec);
+	} else {
+		snprintf(buf, sizeof(buf), "0 %lu", length);
+	}
+	return string(buf);
+}
+
+bool write_rtpt(const vector<GenTask> &taskset, unsigned sys_first_core, unsigned sys_last_core,
+				const string &workload, const string &file_name) {
+	// Since periods are multiple of each other by factor of 2,
+	// the hyper-period is just the maximum period among tasks
+	unsigned long hyper_period = 0;
+	for (unsigned i=0; i<taskset.size(); i++) {
+		hyper_period = max(hyper_period, taskset[i].period);
+	}
+
+	char buf[128];
+	snprintf(buf, sizeof(buf), "%u %u\n", sys_first_core, sys_last_core);
+	string lines(buf);
+
+	for (unsigned i=0; i<taskset.size(); i++) {
+		const GenTask &task = taskset[i];
+
+		// A line for command line arguments
+		snprintf(buf, sizeof(buf), "synthetic_task %u ", (unsigned)task.program.size());
+		lines += buf;
+		unsigned long work = 0, span = 0;
+		for (unsigned j=0; j<task.program.size(); j++) {
+			const Segment &segment = task.program[j];
+			span += segment.len;
+			work += segment.len * segment.num_strands;
+			unsigned long len_sec = 0, len_nsec = segment.len;
+			if (segment.len >= kNsecPerSec) {
+				len_sec = segment.len/kNsecPerSec;
+				len_nsec = segment.len - kNsecPerSec*len_sec;
+			}
+			snprintf(buf, sizeof(buf), "%u %lu %lu ", segment.num_strands, len_sec, len_nsec);
+			lines += buf;
+			if (!workload.empty()) {
+				lines += workload + " ";
+			}
+		}
+		lines += "\n";
+
+		// A line for timing parameters
+		string period = timespec_string(task.period);
+		unsigned long num_iters = kNumHyperPeriod * (hyper_period/task.period);
+		lines += timespec_string(work) + " " + timespec_string(span) + " " + period + " " + period;
+		snprintf(buf, sizeof(buf), " 0 0 %lu\n", num_iters);
+		lines += buf;
+	}
+
+	FILE *fp = fopen(file_name.c_str(), "w");
+	if (fp == NULL) {
+		fprintf(stderr, "ERROR: Cannot open file %s\n", file_name.c_str());
+		return false;
+	}
+	fwrite(lines.data(), 1, lines.size(), fp);
+	fclose(fp);
+	return true;
+}
+
+// Format a number the way Python's str() does, for the folder names
+static string py_str(double value) {
+	char buf[64];
+	for (int precision=1; precision<=17; precision++) {
+		snprintf(buf, sizeof(buf), "%.*g", precision, value);
+		if (strtod(buf, NULL) == value) break;
+	}
+	string s(buf);
+	if (s.find_first_of(".e") == string::npos) s += ".0";
+	return s;
+}
+
+const char *init_config(Config &config) {
+	// Total utilization
+	double u = config.m * config.norm_util;
+
+	// Set the range of utilization for each individual task
+	config.util_min = 1.25;
+	config.util_max = (config.type == VARYING_PARALLELISM) ? sqrt((double)config.m) : u;
+
+	if (config.type == VARYING_UTIL_LOST) {
+		// The sum of the total utilization and the total utilization lost must be an integer
+		// (i.e., the total cores required by the federated scheduling for this task set)
+		double u_lost = config.m * config.norm_util_lost;
+		if (ceil(u + u_lost) - (u + u_lost) != 0) {
+			return "Total utilization + total utilization lost must be an integer";
+		}
+	}
+
+	// Check the if the number of tasks is valid
+	if (config.num_tasks == 0 ||
+		config.num_tasks > floor(u/config.util_min) || config.num_tasks < ceil(u/config.util_max)) {
+		return "Number of tasks must not be too small or too large";
+	}
+	return NULL;
+}
+
+string taskset_directory(const string &folder, const Config &config) {
+	string directory = folder + "/core=" + to_string(config.m) + "n=" + to_string(config.num_tasks) +
+		"util=" + py_str(config.norm_util);
+	if (config.type == VARYING_UTIL_LOST) {
+		directory += "lost=" + py_str(config.norm_util_lost);
+	} else if (config.type == VARYING_PARALLELISM) {
+		directory += "para=" + to_string(config.para_low) + "_" + to_string(config.para_high);
+	}
+	return directory;
+}
+
+vector<TaskSpec> to_task_specs(const vector<GenTask> &taskset) {
+	unsigned long hyper_period = 0;
+	for (unsigned i=0; i<taskset.size(); i++) {
+		hyper_period = max(hyper_period, taskset[i].period);
+	}
+
+	vector<TaskSpec> tasks(taskset.size());
+	for (unsigned i=0; i<taskset.size(); i++) {
+		const GenTask &gen_task = taskset[i];
+		TaskSpec &task = tasks[i];
+		task.id = i + 1;
+		task.program_name = "synthetic_task";
+		task.work = 0;
+		task.span = 0;
+		for (unsigned j=0; j<gen_task.program.size(); j++) {
+			const Segment &segment = gen_task.program[j];
+			SegmentSpec segment_spec;
+			segment_spec.num_strands = segment.num_strands;
+			segment_spec.len = segment.len;
+			task.segments.push_back(segment_spec);
+			task.span += segment.len;
+			task.work += segment.len * segment.num_strands;
+		}
+		task.period = gen_task.period;
+		task.deadline = gen_task.period;
+		task.release = 0;
+		task.num_iters = kNumHyperPeriod * (hyper_period/gen_task.period);
+		task.first_core = -1;
+		task.last_core = -1;
+		task.priority = -1;
+		task.edf_pool = false;
+	}
+	return tasks;
+}
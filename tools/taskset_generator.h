@@ -0,0 +1,77 @@
+// Random generation of task sets for GEDF vs. FS experiments, like
+// taskset_generate.py, shared by taskset_gen (which writes them to .rtpt files)
+// and sweep (which evaluates them over a grid of parameters).
+//
+// There are three types of experiments, as in taskset_generate.py:
+// - varying number of tasks (main_varying_num_tasks): the tasks' span is a
+//   random fraction of their period,
+// - varying parallelism (main_varying_parallelism): the tasks' parallelism
+//   C/L is drawn from [para_low, para_high),
+// - varying total utilization lost (main_varying_util_lost): the tasks are
+//   generated so that FS requires m*(norm_util + norm_util_lost) cores in total.
+
+#ifndef TASKSET_GENERATOR_H
+#define TASKSET_GENERATOR_H
+
+#include <string>
+#include <vector>
+#include <random>
+#include "taskset_io.h"
+
+typedef std::mt19937_64 Rng;
+
+// Types of experiments
+enum Experiment_Type {
+	VARYING_NUM_TASKS,
+	VARYING_PARALLELISM,
+	VARYING_UTIL_LOST
+};
+
+// Parameters of the experiment
+typedef struct Config {
+	Experiment_Type type;
+	unsigned m; // number of cores
+	unsigned num_tasks;
+	double norm_util;
+	double norm_util_lost;
+	double util_min; // set by init_config
+	double util_max;
+	unsigned para_low;
+	unsigned para_high;
+} Config;
+
+// A segment of a program: [segid, #strands, segment length]
+typedef struct Segment {
+	unsigned id;
+	unsigned num_strands;
+	unsigned long len;
+} Segment;
+
+// A generated task: period and program structure
+typedef struct GenTask {
+	unsigned long period;
+	std::vector<Segment> program;
+} GenTask;
+
+// Set the range of the tasks' utilizations for the experiment of @config
+// and check that it can be generated. Return NULL if it can, or else the
+// reason why it cannot.
+const char *init_config(Config &config);
+
+// Folder of the task sets of @config under @folder:
+// <folder>/core=<m>n=<num_tasks>util=<norm_util>[para=<low>_<high>][lost=<norm_util_lost>]
+std::string taskset_directory(const std::string &folder, const Config &config);
+
+// Generate a task set for the experiment of @config (see init_config)
+std::vector<GenTask> taskset_generate(const Config &config, Rng &rng);
+
+// The generated tasks as read from a .rtpt file, for the analyses
+std::vector<TaskSpec> to_task_specs(const std::vector<GenTask> &taskset);
+
+// Write the tasks' structures to an .rtpt file, in the format of
+// write_to_rtpt(). With a @workload, every segment runs it (see workload.h).
+// Errors are reported to stderr and false is returned.
+bool write_rtpt(const std::vector<GenTask> &taskset, unsigned sys_first_core, unsigned sys_last_core,
+				const std::string &workload, const std::string &file_name);
+
+#endif // TASKSET_GENERATOR_H